@@ -0,0 +1,674 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "Bitbase.h"
+
+#define BIT(square) ((uint64_t)1 << (square))
+#define FILE_OF(square) ((square) & 7)
+#define RANK_OF(square) ((square) >> 3)
+#define TRANSPOSE(square) ((FILE_OF(square) << 3) | RANK_OF(square))
+
+#define NUM_OF_THREADS   4
+#define ENTRY_BITS       6
+#define ENTRY_MASK       ((1 << ENTRY_BITS) - 1)
+#define ENTRIES_PER_WORD 5
+#define FILE_MAGIC       "KXKBB01\n"
+
+#define KQK  0
+#define KRK  1
+#define KBNK 2
+#define KPK  3
+#define NUM_OF_BITBASES 4
+
+/*
+ * A position of a bitbase, seen from the stronger player as if it were white.
+ * (squares) holds the strong king, the weak king, and then the strong player's other pieces.
+ */
+typedef struct Position{
+	int strongToMove;
+	int squares[4];
+} Position;
+
+/*
+ * The positions are indexed by the player to move, the strong king, the weak king and the other pieces.
+ * Without pawns, the board is rotated and mirrored so that the strong king is on a1-d1-d4, one of 10 squares.
+ * Each result takes ENTRY_BITS bits: the number of moves the strong player needs to mate, 0 for a draw.
+ * While generating, (plies) holds one byte per position: the number of plies until mate plus 1, 0 if not known yet.
+ */
+typedef struct Bitbase{
+	int numOfPieces;
+	char pieceTypes[2];
+	int symmetric;
+	long size;
+	uint32_t* results;
+	unsigned char* plies;
+	int maxPlies;
+} Bitbase;
+
+static Bitbase bitbases[NUM_OF_BITBASES] = {
+	{1, {Board_QUEEN, 0},             1},
+	{1, {Board_ROOK, 0},              1},
+	{2, {Board_BISHOP, Board_KNIGHT}, 1},
+	{1, {Board_PAWN, 0},              0}
+};
+
+static const char* bitbaseNames[NUM_OF_BITBASES] = {"KQK", "KRK", "KBNK", "KPK"};
+
+/* 1 once the results are loaded or generated, until then nothing is found in the bitbases */
+static int available = 0;
+
+static const int triangleSquares[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+static signed char triangleIndex[64];
+static uint64_t kingSteps[64];
+static uint64_t knightJumps[64];
+
+static const int diagonals[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int lines[4][2]     = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int kingDeltas[8][2]   = {{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1}};
+static const int knightDeltas[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+/*
+ * One thread's share of a generation pass.
+ */
+typedef struct Worker{
+	Bitbase* bitbase;
+	long from, to;
+	int pass;
+	long found;
+} Worker;
+
+static void initTables(){
+	memset(triangleIndex, -1, sizeof(triangleIndex));
+	for (int i = 0; i < 10; i++){
+		triangleIndex[triangleSquares[i]] = i;
+	}
+	for (int square = 0; square < 64; square++){
+		kingSteps[square] = 0;
+		knightJumps[square] = 0;
+		for (int i = 0; i < 8; i++){
+			int x = FILE_OF(square) + kingDeltas[i][0];
+			int y = RANK_OF(square) + kingDeltas[i][1];
+			if (x >= 0 && x < 8 && y >= 0 && y < 8){
+				kingSteps[square] |= BIT(y*8 + x);
+			}
+			x = FILE_OF(square) + knightDeltas[i][0];
+			y = RANK_OF(square) + knightDeltas[i][1];
+			if (x >= 0 && x < 8 && y >= 0 && y < 8){
+				knightJumps[square] |= BIT(y*8 + x);
+			}
+		}
+	}
+}
+
+static int popSquare(uint64_t* squares){
+	int square = __builtin_ctzll(*squares);
+	*squares &= *squares - 1;
+	return square;
+}
+
+static uint64_t slide(int square, uint64_t occupied, const int directions[4][2]){
+	uint64_t attacks = 0;
+	for (int i = 0; i < 4; i++){
+		int x = FILE_OF(square) + directions[i][0];
+		int y = RANK_OF(square) + directions[i][1];
+		while (x >= 0 && x < 8 && y >= 0 && y < 8){
+			attacks |= BIT(y*8 + x);
+			if (occupied & BIT(y*8 + x)){
+				break;
+			}
+			x += directions[i][0];
+			y += directions[i][1];
+		}
+	}
+	return attacks;
+}
+
+/*
+ * @return: the squares a white piece of the given type on (square) attacks
+ */
+static uint64_t getAttacks(int type, int square, uint64_t occupied){
+	switch (type){
+		case Board_PAWN:
+			if (RANK_OF(square) == 7){
+				return 0;
+			}
+			return ((FILE_OF(square) > 0)? BIT(square+7): 0) | ((FILE_OF(square) < 7)? BIT(square+9): 0);
+		case Board_KNIGHT: return knightJumps[square];
+		case Board_BISHOP: return slide(square, occupied, diagonals);
+		case Board_ROOK:   return slide(square, occupied, lines);
+		case Board_QUEEN:  return slide(square, occupied, diagonals) | slide(square, occupied, lines);
+		case Board_KING:   return kingSteps[square];
+	}
+	return 0;
+}
+
+static int getPieceType(Bitbase* bitbase, int piece){
+	return (piece < 2)? Board_KING: bitbase->pieceTypes[piece-2];
+}
+
+static uint64_t getOccupied(Bitbase* bitbase, Position* position){
+	uint64_t occupied = 0;
+	for (int i = 0; i < 2 + bitbase->numOfPieces; i++){
+		occupied |= BIT(position->squares[i]);
+	}
+	return occupied;
+}
+
+/*
+ * @params: (capturedSquare) - a square whose piece is ignored, -1 if none
+ * @return: the squares the strong player attacks
+ */
+static uint64_t getStrongAttacks(Bitbase* bitbase, Position* position, uint64_t occupied, int capturedSquare){
+	uint64_t attacks = kingSteps[position->squares[0]];
+	for (int i = 2; i < 2 + bitbase->numOfPieces; i++){
+		if (position->squares[i] != capturedSquare){
+			attacks |= getAttacks(getPieceType(bitbase, i), position->squares[i], occupied);
+		}
+	}
+	return attacks;
+}
+
+static int isLegal(Bitbase* bitbase, Position* position){
+	int numOfSquares = 2 + bitbase->numOfPieces;
+	for (int i = 0; i < numOfSquares; i++){
+		for (int j = 0; j < i; j++){
+			if (position->squares[i] == position->squares[j]){
+				return 0;
+			}
+		}
+		if (getPieceType(bitbase, i) == Board_PAWN && RANK_OF(position->squares[i]) == 7){
+			return 0;
+		}
+	}
+	int weakKing = position->squares[1];
+	if (kingSteps[position->squares[0]] & BIT(weakKing)){
+		return 0;
+	}
+	// the player who is not to move cannot be in check
+	return !position->strongToMove
+		|| !(getStrongAttacks(bitbase, position, getOccupied(bitbase, position), -1) & BIT(weakKing));
+}
+
+/*
+ * @return: the index of (position) in (bitbase)
+ */
+static long getIndex(Bitbase* bitbase, Position* position){
+	int numOfSquares = 2 + bitbase->numOfPieces;
+	int squares[4];
+	memcpy(squares, position->squares, sizeof(squares));
+	int kingIndex = squares[0];
+	if (bitbase->symmetric){
+		int flip = ((FILE_OF(squares[0]) > 3)? 7: 0) ^ ((RANK_OF(squares[0]) > 3)? 56: 0);
+		for (int i = 0; i < numOfSquares; i++){
+			squares[i] ^= flip;
+		}
+		// with the king on the diagonal, the first piece off the diagonal decides whether to transpose
+		int transpose = 0;
+		for (int i = 0; i < numOfSquares; i++){
+			if (RANK_OF(squares[i]) != FILE_OF(squares[i])){
+				transpose = RANK_OF(squares[i]) > FILE_OF(squares[i]);
+				break;
+			}
+		}
+		if (transpose){
+			for (int i = 0; i < numOfSquares; i++){
+				squares[i] = TRANSPOSE(squares[i]);
+			}
+		}
+		kingIndex = triangleIndex[squares[0]];
+	}
+	long index = (position->strongToMove? 0: 1)*(bitbase->symmetric? 10: 64) + kingIndex;
+	for (int i = 1; i < numOfSquares; i++){
+		index = index*64 + squares[i];
+	}
+	return index;
+}
+
+static void getPosition(Bitbase* bitbase, long index, Position* position){
+	for (int i = 1 + bitbase->numOfPieces; i >= 1; i--){
+		position->squares[i] = index % 64;
+		index /= 64;
+	}
+	int numOfKingSquares = bitbase->symmetric? 10: 64;
+	int kingIndex = index % numOfKingSquares;
+	position->squares[0] = bitbase->symmetric? triangleSquares[kingIndex]: kingIndex;
+	position->strongToMove = (index / numOfKingSquares == 0);
+}
+
+/*
+ * @return: the number of plies until the strong player mates from the position at (index),
+ *          -1 if the position is a draw
+ */
+static int getStoredPlies(Bitbase* bitbase, long index, int strongToMove){
+	int moves = (bitbase->results[index / ENTRIES_PER_WORD] >> (ENTRY_BITS*(index % ENTRIES_PER_WORD))) & ENTRY_MASK;
+	if (moves == 0){
+		return -1;
+	}
+	return strongToMove? 2*moves - 1: 2*(moves - 1);
+}
+
+/*
+ * Finds the positions the weak king, to move on (position), can move to.
+ *
+ * @return: the number of moves, -1 if the weak king can capture a piece, which draws
+ */
+static int getWeakKingMoves(Bitbase* bitbase, Position* position, Position moves[8]){
+	uint64_t occupied = getOccupied(bitbase, position);
+	int weakKing = position->squares[1];
+	uint64_t targets = kingSteps[weakKing];
+	int numOfMoves = 0;
+	while (targets){
+		int square = popSquare(&targets);
+		if (getStrongAttacks(bitbase, position, occupied & ~BIT(weakKing), square) & BIT(square)){
+			continue;
+		}
+		if (occupied & BIT(square)){
+			return -1;
+		}
+		moves[numOfMoves] = *position;
+		moves[numOfMoves].strongToMove = 1;
+		moves[numOfMoves].squares[1] = square;
+		numOfMoves++;
+	}
+	return numOfMoves;
+}
+
+static int isMated(Bitbase* bitbase, Position* position){
+	Position moves[8];
+	return getWeakKingMoves(bitbase, position, moves) == 0
+		&& (getStrongAttacks(bitbase, position, getOccupied(bitbase, position), -1) & BIT(position->squares[1]));
+}
+
+/*
+ * @return: 1 if every move of the weak king leads to a position already known to be won, 0 otherwise
+ */
+static int isLost(Bitbase* bitbase, Position* position){
+	Position moves[8];
+	int numOfMoves = getWeakKingMoves(bitbase, position, moves);
+	if (numOfMoves <= 0){
+		return 0;
+	}
+	for (int i = 0; i < numOfMoves; i++){
+		if (bitbase->plies[getIndex(bitbase, &moves[i])] == 0){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Marks as won in (pass) plies the positions from which the strong player can move to (position),
+ * which is lost in (pass-1) plies.
+ *
+ * @return: the number of positions marked
+ */
+static long addStrongPredecessors(Bitbase* bitbase, Position* position, int pass){
+	uint64_t occupied = getOccupied(bitbase, position);
+	long found = 0;
+	for (int i = 0; i < 2 + bitbase->numOfPieces; i++){
+		if (i == 1){
+			continue;
+		}
+		int type = getPieceType(bitbase, i);
+		int square = position->squares[i];
+		uint64_t origins;
+		if (type == Board_PAWN){
+			origins = (square >= 8)? BIT(square-8) & ~occupied: 0;
+		}
+		else{
+			origins = getAttacks(type, square, occupied) & ~occupied;
+		}
+		while (origins){
+			Position predecessor = *position;
+			predecessor.strongToMove = 1;
+			predecessor.squares[i] = popSquare(&origins);
+			if (!isLegal(bitbase, &predecessor)){
+				continue;
+			}
+			long index = getIndex(bitbase, &predecessor);
+			if (bitbase->plies[index] == 0){
+				bitbase->plies[index] = pass + 1;
+				found++;
+			}
+		}
+	}
+	return found;
+}
+
+/*
+ * Marks as lost in (pass) plies the positions from which every move of the weak king leads
+ * to a won position, one of them being (position), which is won in (pass-1) plies.
+ *
+ * @return: the number of positions marked
+ */
+static long addWeakPredecessors(Bitbase* bitbase, Position* position, int pass){
+	uint64_t origins = kingSteps[position->squares[1]] & ~getOccupied(bitbase, position);
+	long found = 0;
+	while (origins){
+		Position predecessor = *position;
+		predecessor.strongToMove = 0;
+		predecessor.squares[1] = popSquare(&origins);
+		if (!isLegal(bitbase, &predecessor)){
+			continue;
+		}
+		long index = getIndex(bitbase, &predecessor);
+		if (bitbase->plies[index] == 0 && isLost(bitbase, &predecessor)){
+			bitbase->plies[index] = pass + 1;
+			found++;
+		}
+	}
+	return found;
+}
+
+/*
+ * Runs one pass of the generation over a slice of the positions.
+ * Pass 0 finds the mates, odd passes the positions won in (pass) plies,
+ * and even passes the positions lost in (pass) plies.
+ * Threads only ever mark positions with the same value during a pass, so they need no locking.
+ */
+static int generateSlice(void* data){
+	Worker* worker = (Worker*)data;
+	Bitbase* bitbase = worker->bitbase;
+	worker->found = 0;
+	for (long index = worker->from; index < worker->to; index++){
+		Position position;
+		if (worker->pass == 0){
+			getPosition(bitbase, index, &position);
+			if (!position.strongToMove && isLegal(bitbase, &position) && isMated(bitbase, &position)){
+				bitbase->plies[index] = 1;
+				worker->found++;
+			}
+		}
+		else if (bitbase->plies[index] == worker->pass){
+			getPosition(bitbase, index, &position);
+			worker->found += (worker->pass % 2)?
+					addStrongPredecessors(bitbase, &position, worker->pass):
+					addWeakPredecessors(bitbase, &position, worker->pass);
+		}
+	}
+	return 0;
+}
+
+/*
+ * @return: the number of positions marked by the pass
+ */
+static long runPass(Bitbase* bitbase, int pass){
+	Worker workers[NUM_OF_THREADS];
+	SDL_Thread* threads[NUM_OF_THREADS];
+	long sliceSize = (bitbase->size + NUM_OF_THREADS - 1) / NUM_OF_THREADS;
+	for (int i = 0; i < NUM_OF_THREADS; i++){
+		workers[i].bitbase = bitbase;
+		workers[i].from = i*sliceSize;
+		workers[i].to = ((i+1)*sliceSize < bitbase->size)? (i+1)*sliceSize: bitbase->size;
+		workers[i].pass = pass;
+#ifdef SINGLE_THREADED
+		threads[i] = NULL;
+#else
+		threads[i] = SDL_CreateThread(&generateSlice, &workers[i]);
+#endif
+		if (!threads[i]){ // do the work here instead
+			generateSlice(&workers[i]);
+		}
+	}
+	long found = 0;
+	for (int i = 0; i < NUM_OF_THREADS; i++){
+		if (threads[i]){
+			SDL_WaitThread(threads[i], NULL);
+		}
+		found += workers[i].found;
+	}
+	return found;
+}
+
+/*
+ * Marks as won in (pass) plies the positions of KPK where promoting the pawn
+ * to a queen or a rook leads to a position of KQK or KRK lost in (pass-1) plies.
+ *
+ * @return: the number of positions marked
+ */
+static long addPromotions(Bitbase* bitbase, int pass){
+	static const int promotions[2] = {KQK, KRK};
+	long found = 0;
+	for (int strongKing = 0; strongKing < 64; strongKing++){
+		for (int weakKing = 0; weakKing < 64; weakKing++){
+			for (int pawn = 48; pawn < 56; pawn++){
+				Position position = {1, {strongKing, weakKing, pawn, 0}};
+				if (!isLegal(bitbase, &position) || strongKing == pawn+8 || weakKing == pawn+8){
+					continue;
+				}
+				long index = getIndex(bitbase, &position);
+				if (bitbase->plies[index] != 0){
+					continue;
+				}
+				Position promoted = {0, {strongKing, weakKing, pawn+8, 0}};
+				for (int i = 0; i < 2; i++){
+					Bitbase* promotedBitbase = &bitbases[promotions[i]];
+					if (getStoredPlies(promotedBitbase, getIndex(promotedBitbase, &promoted), 0) + 1 == pass){
+						bitbase->plies[index] = pass + 1;
+						found++;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return found;
+}
+
+/*
+ * Packs the results of the generation, in moves until mate.
+ */
+static void packResults(Bitbase* bitbase){
+	memset(bitbase->results, 0, (bitbase->size + ENTRIES_PER_WORD - 1) / ENTRIES_PER_WORD * sizeof(uint32_t));
+	bitbase->maxPlies = 0;
+	for (long index = 0; index < bitbase->size; index++){
+		if (bitbase->plies[index] == 0){
+			continue;
+		}
+		int plies = bitbase->plies[index] - 1;
+		int strongToMove = (index < bitbase->size/2);
+		uint32_t moves = strongToMove? (plies + 1)/2: plies/2 + 1;
+		bitbase->results[index / ENTRIES_PER_WORD] |= moves << (ENTRY_BITS*(index % ENTRIES_PER_WORD));
+		bitbase->maxPlies = (plies > bitbase->maxPlies)? plies: bitbase->maxPlies;
+	}
+}
+
+/*
+ * Generates a bitbase by retrograde analysis: starting from the mates, each pass finds
+ * the positions one ply further from mate, until no more are found.
+ * KPK is generated last, since its promotions lead to KQK and KRK.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int generate(Bitbase* bitbase){
+	bitbase->plies = (unsigned char*)calloc(bitbase->size, 1);
+	if (!bitbase->plies){
+		return -1;
+	}
+	int horizon = 0;
+	if (bitbase == &bitbases[KPK]){
+		horizon = (bitbases[KQK].maxPlies > bitbases[KRK].maxPlies)? bitbases[KQK].maxPlies: bitbases[KRK].maxPlies;
+	}
+	runPass(bitbase, 0);
+	int quietPasses = 0;
+	for (int pass = 1; quietPasses < 2 || pass <= horizon + 1; pass++){
+		long found = runPass(bitbase, pass);
+		if (bitbase == &bitbases[KPK] && pass % 2){
+			found += addPromotions(bitbase, pass);
+		}
+		quietPasses = found? 0: quietPasses + 1;
+	}
+	packResults(bitbase);
+	free(bitbase->plies);
+	bitbase->plies = NULL;
+	return 0;
+}
+
+static int loadBitbases(){
+	FILE* file = fopen(Bitbase_FILE, "rb");
+	if (!file){
+		return 0;
+	}
+	char magic[8];
+	int loaded = fread(magic, 1, 8, file) == 8 && memcmp(magic, FILE_MAGIC, 8) == 0;
+	for (int i = 0; loaded && i < NUM_OF_BITBASES; i++){
+		size_t numOfWords = (bitbases[i].size + ENTRIES_PER_WORD - 1) / ENTRIES_PER_WORD;
+		loaded = fread(bitbases[i].results, sizeof(uint32_t), numOfWords, file) == numOfWords;
+	}
+	fclose(file);
+	return loaded;
+}
+
+/*
+ * @return: 1 if the file could not be written, 0 otherwise
+ */
+static int saveBitbases(){
+	FILE* file = fopen(Bitbase_FILE, "wb");
+	if (!file){
+		return 1;
+	}
+	int saved = fwrite(FILE_MAGIC, 1, 8, file) == 8;
+	for (int i = 0; saved && i < NUM_OF_BITBASES; i++){
+		size_t numOfWords = (bitbases[i].size + ENTRIES_PER_WORD - 1) / ENTRIES_PER_WORD;
+		saved = fwrite(bitbases[i].results, sizeof(uint32_t), numOfWords, file) == numOfWords;
+	}
+	return (fclose(file) != 0 || !saved);
+}
+
+static void freeResults(){
+	for (int i = 0; i < NUM_OF_BITBASES; i++){
+		free(bitbases[i].results);
+		bitbases[i].results = NULL;
+	}
+}
+
+/*
+ * Sets up the tables and allocates the results of every bitbase.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int allocateResults(){
+	initTables();
+	for (int i = 0; i < NUM_OF_BITBASES; i++){
+		Bitbase* bitbase = &bitbases[i];
+		bitbase->size = 2*(bitbase->symmetric? 10: 64)*64;
+		for (int j = 0; j < bitbase->numOfPieces; j++){
+			bitbase->size *= 64;
+		}
+		bitbase->results = (uint32_t*)calloc((bitbase->size + ENTRIES_PER_WORD - 1) / ENTRIES_PER_WORD, sizeof(uint32_t));
+		if (!bitbase->results){
+			freeResults();
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Loads the bitbases from Bitbase_FILE. Without the file, which Bitbase_build creates, 
+ * nothing is found in the bitbases and endgames are searched like any other position.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+int Bitbase_init(){
+	if (allocateResults()){
+		return -1;
+	}
+	available = loadBitbases();
+	if (!available){
+		freeResults();
+	}
+	return 0;
+}
+
+/*
+ * Generates the bitbases by retrograde analysis, which takes a while, and saves them at Bitbase_FILE.
+ *
+ * @return: 1 if an allocation error occurred, -9 if the file could not be written, 0 otherwise
+ */
+int Bitbase_build(){
+	if (allocateResults()){
+		return 1;
+	}
+	for (int i = 0; i < NUM_OF_BITBASES; i++){
+		printf("Generating the %s bitbase\n", bitbaseNames[i]);
+		fflush(stdout);
+		if (generate(&bitbases[i])){
+			freeResults();
+			return 1;
+		}
+	}
+	available = 1;
+	if (saveBitbases()){
+		return -9;
+	}
+	printf("Saved the bitbases at %s\n", Bitbase_FILE);
+	return 0;
+}
+
+/*
+ * Looks up the result of (board) with (player) to move.
+ *
+ * @params: (plies) - set to the number of plies until mate, if (board) is not a draw
+ * @return: Bitbase_NOT_FOUND if none of the bitbases holds (board),
+ *          otherwise Bitbase_WIN, Bitbase_LOSS or Bitbase_DRAW for (player)
+ */
+int Bitbase_probe(Board* board, int player, int* plies){
+	if (!available){
+		return Bitbase_NOT_FOUND;
+	}
+	int strong;
+	if (__builtin_popcountll(board->occupied[BLACK]) == 1){
+		strong = WHITE;
+	}
+	else if (__builtin_popcountll(board->occupied[WHITE]) == 1){
+		strong = BLACK;
+	}
+	else{
+		return Bitbase_NOT_FOUND;
+	}
+	// castling is not part of the bitbases
+	if (board->castlingRights & (Board_CASTLING_RIGHT(strong, QUEEN_SIDE) | Board_CASTLING_RIGHT(strong, KING_SIDE))){
+		return Bitbase_NOT_FOUND;
+	}
+	uint64_t pieces = board->occupied[strong] & ~BIT(board->kingSquare[strong]);
+	int numOfPieces = __builtin_popcountll(pieces);
+	int mirror = (strong == WHITE)? 0: 56; // the stronger player is seen as white
+	Position position;
+	position.strongToMove = (player == strong);
+	position.squares[0] = board->kingSquare[strong] ^ mirror;
+	position.squares[1] = board->kingSquare[!strong] ^ mirror;
+	char types[2] = {0, 0};
+	for (int i = 0; i < numOfPieces && i < 2; i++){
+		int square = popSquare(&pieces);
+		types[i] = Board_TYPE_OF(Board_getPiece(board, Board_FILE(square), Board_RANK(square)));
+		position.squares[2+i] = square ^ mirror;
+	}
+	for (int i = 0; i < NUM_OF_BITBASES; i++){
+		Bitbase* bitbase = &bitbases[i];
+		if (bitbase->numOfPieces != numOfPieces){
+			continue;
+		}
+		if (numOfPieces == 2 && types[0] == bitbase->pieceTypes[1] && types[1] == bitbase->pieceTypes[0]){
+			int square = position.squares[2];
+			position.squares[2] = position.squares[3];
+			position.squares[3] = square;
+			char type = types[0];
+			types[0] = types[1];
+			types[1] = type;
+		}
+		if (types[0] != bitbase->pieceTypes[0] || types[1] != bitbase->pieceTypes[1]){
+			continue;
+		}
+		int storedPlies = getStoredPlies(bitbase, getIndex(bitbase, &position), position.strongToMove);
+		if (storedPlies == -1){
+			return Bitbase_DRAW;
+		}
+		*plies = storedPlies;
+		return position.strongToMove? Bitbase_WIN: Bitbase_LOSS;
+	}
+	return Bitbase_NOT_FOUND;
+}
@@ -0,0 +1,25 @@
+#ifndef BITBASE_H
+#define BITBASE_H
+
+#include "Board.h"
+
+/*
+ * Exact results of the endgames where one player has only its king left
+ * and the other a queen, a rook, a pawn, or a bishop and a knight:
+ * for every position, whether the stronger player mates and in how many moves.
+ * The tables are read from Bitbase_FILE, which "chessprog build_bitbases" generates by retrograde analysis.
+ */
+#define Bitbase_FILE "bitbases.bin"
+
+#define Bitbase_NOT_FOUND -1
+#define Bitbase_DRAW       0
+#define Bitbase_WIN        1
+#define Bitbase_LOSS       2
+
+int Bitbase_init();
+
+int Bitbase_build();
+
+int Bitbase_probe(Board* board, int player, int* plies);
+
+#endif
@@ -1,14 +1,182 @@
+#define _POSIX_C_SOURCE 200112L /* posix_memalign */
+
 #include <stdio.h>
-#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MATERIAL_SIMD
+#endif
 
 #include "Board.h"
 #include "PossibleMove.h"
 #include "LinkedList.h"
 #include "PossibleMoveList.h"
 
+/* the packed layout must stay within a single cache line */
+typedef char Board_fitsInOneCacheLine[(sizeof(Board) == 64)? 1: -1];
+
+const signed char Board_pieceColor[16] = {
+	-1,    WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, -1,
+	-1,    BLACK, BLACK, BLACK, BLACK, BLACK, BLACK, -1
+};
+
+const unsigned char Board_pieceType[16] = {
+	0, Board_PAWN, Board_KNIGHT, Board_BISHOP, Board_ROOK, Board_QUEEN, Board_KING, 0,
+	0, Board_PAWN, Board_KNIGHT, Board_BISHOP, Board_ROOK, Board_QUEEN, Board_KING, 0
+};
+
+const int Board_pieceValue[16] = {
+	0,  1,  3,  3,  5,  9,  400, 0,
+	0, -1, -3, -3, -5, -9, -400, 0
+};
+
+/* 
+ * The characters representing each piece in the console and in saved games.
+ */
+static const char pieceChars[16] = {
+	' ', 'm', 'n', 'b', 'r', 'q', 'k', ' ',
+	' ', 'M', 'N', 'B', 'R', 'Q', 'K', ' '
+};
+
+/*
+ * @return: the character representing (piece) in the console and in saved games
+ */
+char Board_pieceToChar(char piece){
+	return pieceChars[(unsigned char)piece];
+}
+
+/*
+ * @return: the piece represented by the character (ch), 
+ *          Board_EMPTY if it does not represent any piece
+ */
+char Board_charToPiece(char ch){
+	for (int piece = Board_WHITE_PAWN; piece <= Board_BLACK_KING; piece++){
+		if (ch != ' ' && pieceChars[piece] == ch){
+			return piece;
+		}
+	}
+	return Board_EMPTY;
+}
+
+#define BIT(square) ((uint64_t)1 << (square))
+
+/*
+ * @return: the 4-bit code stored at (square)
+ */
+static int getCode(Board* board, int square){
+	return (board->squares[square >> 1] >> ((square & 1) << 2)) & 0xF;
+}
+
+/*
+ * Random keys for hashing positions (Zobrist hashing): one for each piece on each square,
+ * one for each set of castling rights and one for white being the next to move.
+ * The keys of an empty square and of no castling rights are 0, so a cleared board has key 0.
+ */
+static uint64_t pieceKeys[16][Board_SIZE*Board_SIZE];
+static uint64_t castlingKeys[Board_ALL_CASTLING_RIGHTS+1];
+static uint64_t whiteToMoveKey;
+
+/* the keys of the pawns for the pawn key, 0 for all other pieces */
+static uint32_t pawnKeys[16][Board_SIZE*Board_SIZE];
+
+/*
+ * Advances a xorshift64* generator.
+ *
+ * @return: the next pseudo random key
+ */
+static uint64_t nextRandomKey(uint64_t* state){
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Fills in the hashing keys from a fixed seed, so that a position has the same key on every run.
+ * Must be called once before any board is set up.
+ */
+void Board_initZobristKeys(){
+	uint64_t state = 0x9E3779B97F4A7C15ULL;
+	for (int piece = Board_WHITE_PAWN; piece <= Board_BLACK_KING; piece++){
+		if (Board_COLOR_OF(piece) == -1){
+			continue;
+		}
+		for (int square = 0; square < Board_SIZE*Board_SIZE; square++){
+			pieceKeys[piece][square] = nextRandomKey(&state);
+			if (Board_TYPE_OF(piece) == Board_PAWN){
+				pawnKeys[piece][square] = (uint32_t)(pieceKeys[piece][square] >> 32);
+			}
+		}
+	}
+	for (int rights = 1; rights <= Board_ALL_CASTLING_RIGHTS; rights++){
+		castlingKeys[rights] = nextRandomKey(&state);
+	}
+	whiteToMoveKey = nextRandomKey(&state);
+}
+
+/*
+ * Stores a 4-bit code at (square), and keeps the sets of occupied squares and the keys up to date.
+ */
+static void setCode(Board* board, int square, int code){
+	int shift = (square & 1) << 2;
+	unsigned char* pair = &board->squares[square >> 1];
+	int oldCode = (*pair >> shift) & 0xF;
+	board->key ^= pieceKeys[oldCode][square] ^ pieceKeys[code][square];
+	board->pawnKey ^= pawnKeys[oldCode][square] ^ pawnKeys[code][square];
+	*pair = (*pair & ~(0xF << shift)) | (code << shift);
+	board->occupied[WHITE] &= ~BIT(square);
+	board->occupied[BLACK] &= ~BIT(square);
+	if (code != Board_EMPTY){
+		board->occupied[Board_COLOR_OF(code)] |= BIT(square);
+	}
+}
+
+/*
+ * Replaces the castling rights of (board), and keeps the key up to date.
+ */
+static void setCastlingRights(Board* board, int rights){
+	board->key ^= castlingKeys[board->castlingRights] ^ castlingKeys[rights];
+	board->castlingRights = rights;
+}
+
+/*
+ * Sets the player who moves next on (board).
+ */
+void Board_setSideToMove(Board* board, int player){
+	if (board->sideToMove != player){
+		board->key ^= whiteToMoveKey;
+		board->sideToMove = player;
+	}
+}
+
+/*
+ * Removes the lowest square from a set of squares.
+ *
+ * @return: the removed square
+ */
+static int popSquare(uint64_t* squares){
+	int square = __builtin_ctzll(*squares);
+	*squares &= *squares - 1;
+	return square;
+}
+
+
+/*
+ * Allocates an uninitialized board on a cache line boundary.
+ *
+ * @return:  NULL if an allocation error occurred, 
+ *           a pointer to the board otherwise
+ */
+static Board* allocateBoard(){
+	void* memory;
+	if (posix_memalign(&memory, sizeof(Board), sizeof(Board))){
+		return NULL;
+	}
+	return (Board*)memory;
+}
 
 /*
  * Creates a new board structure.
@@ -17,7 +185,10 @@
  *           a pointer to a new board otherwise
  */
 Board* Board_new(){
-	Board* board = (Board*)calloc(1, sizeof(Board));
+	Board* board = allocateBoard();
+	if (!board){
+		return NULL;
+	}
 	Board_init(board);
 	return board;
 }
@@ -26,6 +197,7 @@ Board* Board_new(){
  * Populates the board in the standard way.
  */
 void Board_init(Board* board){
+	memset(board, 0, sizeof(Board));
 	for (int x = 1; x <= Board_SIZE; x++){
 		Board_setPiece(board, x, 2, Board_WHITE_PAWN);
 		Board_setPiece(board, x, 7, Board_BLACK_PAWN);
@@ -51,12 +223,10 @@ void Board_init(Board* board){
 			Board_setPiece(board, x, y, Board_EMPTY);
 		}
 	}
-	board->kingX[BLACK] = 5;
-	board->kingX[WHITE] = 5;
-	board->kingY[BLACK] = 8;
-	board->kingY[WHITE] = 1;
-	memset(board->hasKingEverMoved, 0, sizeof(board->hasKingEverMoved));
-	memset(board->hasRookEverMoved, 0, sizeof(board->hasRookEverMoved[0][0]) * 2 * 2);
+	board->kingSquare[BLACK] = Board_SQUARE(5, 8);
+	board->kingSquare[WHITE] = Board_SQUARE(5, 1);
+	setCastlingRights(board, Board_ALL_CASTLING_RIGHTS);
+	Board_setSideToMove(board, WHITE);
 }
 
 /*
@@ -64,8 +234,7 @@ void Board_init(Board* board){
  * 			on (board) is a rook, 0 otherwise 
  */
 int pieceIsRook(Board* board, int x, int y){
-	char piece = Board_getPiece(board, x, y);
-	return (piece == 'r' || piece == 'R');
+	return Board_TYPE_OF(Board_getPiece(board, x, y)) == Board_ROOK;
 }
 
 /*
@@ -73,19 +242,18 @@ int pieceIsRook(Board* board, int x, int y){
  * 			on (board) is a king, 0 otherwise 
  */
 int pieceIsKing(Board* board, int x, int y){
-	char piece = Board_getPiece(board, x, y);
-	return (piece == 'k' || piece == 'K');
+	return Board_TYPE_OF(Board_getPiece(board, x, y)) == Board_KING;
 }
 
 /*
  * Clears the board from all pieces.
  */
 void Board_clear(Board* board){
-	for (int x = 0; x < Board_SIZE; x++){
-		for (int y = 0; y < Board_SIZE; y++){
-			board->matrix[x][y] = Board_EMPTY;
-		}
-	}
+	memset(board->squares, 0, sizeof(board->squares));
+	board->occupied[WHITE] = 0;
+	board->occupied[BLACK] = 0;
+	board->pawnKey = 0;
+	board->key = castlingKeys[board->castlingRights] ^ ((board->sideToMove == WHITE)? whiteToMoveKey: 0);
 }
 
 /*
@@ -95,19 +263,7 @@ void Board_clear(Board* board){
  *          (src)  - a pointer to the board according to whom (dest) will be populated
  */
 void Board_copy(Board* dest, Board* src){
-	for (int x = 0; x < Board_SIZE; x++){
-		for (int y = 0; y < Board_SIZE; y++){
-			dest->matrix[x][y] = src->matrix[x][y];
-		}
-	}
-	for (int i = 0; i < 2; i++){
-		dest->kingX[i] = src->kingX[i];
-		dest->kingY[i] = src->kingY[i];
-		dest->hasKingEverMoved[i] = src->hasKingEverMoved[i];
-		dest->hasRookEverMoved[i][0] = src->hasRookEverMoved[i][0];
-		dest->hasRookEverMoved[i][1] = src->hasRookEverMoved[i][1];
-	}
-	
+	*dest = *src;
 }
 
 /*
@@ -117,7 +273,7 @@ void Board_copy(Board* dest, Board* src){
  *          (piece) - the piece to be placed on the board.
  */
 void Board_setPiece(Board* board, int x, int y, char piece){
-	board->matrix[x-1][y-1] = piece;
+	setCode(board, Board_SQUARE(x, y), piece);
 }
 
 /*
@@ -127,7 +283,7 @@ void Board_setPiece(Board* board, int x, int y, char piece){
  * @return: the piece in the specified position
  */
 char Board_getPiece(Board* board, int x, int y){
-	return board->matrix[x-1][y-1];
+	return getCode(board, Board_SQUARE(x, y));
 }
 
 /*
@@ -138,7 +294,7 @@ char Board_getPiece(Board* board, int x, int y){
  */
 char Board_removePiece(Board* board, int x, int y){
 	char piece = Board_getPiece(board, x, y);
-	board->matrix[x-1][y-1] = Board_EMPTY;
+	setCode(board, Board_SQUARE(x, y), Board_EMPTY);
 	return piece;
 }
 
@@ -162,7 +318,7 @@ int Board_isInRange(int x, int y){
  * @return: 1 (true) if the coordinates correspond to an empty tile on the board, 0 (false) otherwise
  */
 int Board_isEmpty(Board* board, int x, int y){
-	return board->matrix[x-1][y-1] == Board_EMPTY;
+	return getCode(board, Board_SQUARE(x, y)) == Board_EMPTY;
 }
 
 /*
@@ -172,26 +328,64 @@ int Board_isEmpty(Board* board, int x, int y){
  * @return: -1 if the position is empty, the color of the piece otherwise
  */
 int Board_getColor(Board* board, int x, int y){
-	if (Board_isEmpty(board, x, y)){
-		return -1;
-	}
-	char piece = Board_getPiece(board, x, y);
-	return piece == toupper(piece)? BLACK: WHITE;
+	return Board_COLOR_OF(getCode(board, Board_SQUARE(x, y)));
 }
 
 /*
- * Updates the player's king's position in the kingX and kingY arrays, 
- * who keep track of both kings and are part of the board structure. 
+ * Updates the player's king's position in the kingSquare array, 
+ * which keeps track of both kings and is part of the board structure. 
  *
- * @params: (board) - the board struct for which the arrays are to be updated
+ * @params: (board) - the board struct for which the array is to be updated
  *			(x, y) the coordinates of the given position
  */
 void Board_updateKingPosition(Board* board, int x, int y){
-	int piece = Board_getPiece(board, x, y);
-	int player = Board_getColor(board, x, y);
-	if (toupper(piece) == Board_BLACK_KING){
-		board->kingX[player] = x;
-		board->kingY[player] = y;
+	char piece = Board_getPiece(board, x, y);
+	if (Board_TYPE_OF(piece) == Board_KING){
+		int player = Board_COLOR_OF(piece);
+		board->kingSquare[player] = Board_SQUARE(x, y);
+	}
+}
+
+/*
+ * @return: 1 if (player) has lost both castling rights, 0 otherwise
+ */
+int Board_hasKingEverMoved(Board* board, int player){
+	int rights = Board_CASTLING_RIGHT(player, QUEEN_SIDE) | Board_CASTLING_RIGHT(player, KING_SIDE);
+	return (board->castlingRights & rights) == 0;
+}
+
+/*
+ * @return: 1 if (player) can no longer castle with the rook on (side), 0 otherwise
+ */
+int Board_hasRookEverMoved(Board* board, int player, int side){
+	return (board->castlingRights & Board_CASTLING_RIGHT(player, side)) == 0;
+}
+
+/*
+ * Sets the castling rights of (board) from the king and rook movement arrays
+ * used by saved games, indexed by player and by side.
+ */
+void Board_setCastlingHistory(Board* board, int hasKingEverMoved[2], int hasRookEverMoved[2][2]){
+	int rights = 0;
+	for (int player = BLACK; player <= WHITE; player++){
+		for (int side = QUEEN_SIDE; side <= KING_SIDE; side++){
+			if (!hasKingEverMoved[player] && !hasRookEverMoved[player][side]){
+				rights |= Board_CASTLING_RIGHT(player, side);
+			}
+		}
+	}
+	setCastlingRights(board, rights);
+}
+
+/*
+ * Clears the castling right belonging to a rook corner, 
+ * once anything moves from or to that corner.
+ */
+static void updateCastlingRights(Board* board, int x, int y){
+	if ((x == 1 || x == Board_SIZE) && (y == 1 || y == Board_SIZE)){
+		int player = (y == 1)? WHITE: BLACK;
+		int side = (x == 1)? QUEEN_SIDE: KING_SIDE;
+		setCastlingRights(board, board->castlingRights & ~Board_CASTLING_RIGHT(player, side));
 	}
 }
 
@@ -203,15 +397,15 @@ void Board_updateKingPosition(Board* board, int x, int y){
  */
 void Board_update(Board* board, PossibleMove* move){
 	char piece = Board_getPiece(board, move->fromX, move->fromY);
-	int player = Board_getColor(board, move->fromX, move->fromY);	
+	int player = Board_COLOR_OF(piece);
+	Board_setSideToMove(board, !player);
 	if(move->toX != 0){ // non-castling move
-		if(toupper(piece) == Board_BLACK_KING){ //keeping track of king movements for castling
-			board->hasKingEverMoved[player] = 1;
-		}	
-		if(toupper(piece) == Board_BLACK_ROOK){ //keeping track of rook movements for castling
-			int locationInRookArray = (move->fromX == 1)? 0 : 1;
-			board->hasRookEverMoved[player][locationInRookArray] = 1;
+		if(Board_TYPE_OF(piece) == Board_KING){ //keeping track of king movements for castling
+			setCastlingRights(board, board->castlingRights & ~(Board_CASTLING_RIGHT(player, QUEEN_SIDE) | Board_CASTLING_RIGHT(player, KING_SIDE)));
 		}
+		//keeping track of rook movements and captures for castling
+		updateCastlingRights(board, move->fromX, move->fromY);
+		updateCastlingRights(board, move->toX, move->toY);
 		Board_removePiece(board, move->fromX, move->fromY);
 		Board_setPiece(board, move->toX, move->toY, piece);
 		Board_updateKingPosition(board, move->toX, move->toY);
@@ -220,23 +414,24 @@ void Board_update(Board* board, PossibleMove* move){
 		}
 	}
 	else{
-		board->hasKingEverMoved[player] = 1;
+		setCastlingRights(board, board->castlingRights & ~(Board_CASTLING_RIGHT(player, QUEEN_SIDE) | Board_CASTLING_RIGHT(player, KING_SIDE)));
 		char rook = (player == WHITE)? Board_WHITE_ROOK: Board_BLACK_ROOK;
 		char king = (player == WHITE)? Board_WHITE_KING: Board_BLACK_KING;
-		int y = board->kingY[player];
+		int kingX = Board_FILE(board->kingSquare[player]);
+		int y = Board_RANK(board->kingSquare[player]);
 		
 		Board_removePiece(board, move->fromX, move->fromY);
-		Board_removePiece(board, board->kingX[player], board->kingY[player]);
+		Board_removePiece(board, kingX, y);
 		
 		if (move->fromX == 1){
 			Board_setPiece(board, 3, y, king);
 			Board_setPiece(board, 4, y, rook);
-			board->kingX[player] = 3;
+			board->kingSquare[player] = Board_SQUARE(3, y);
 		}
 		else{
 			Board_setPiece(board, 7, y, king);
 			Board_setPiece(board, 6, y, rook);
-			board->kingX[player] = 7;
+			board->kingSquare[player] = Board_SQUARE(7, y);
 		}
 	}
 	
@@ -249,7 +444,7 @@ void Board_update(Board* board, PossibleMove* move){
  * @return: NULL if any allocation errors occurred, the new board otherwise
  */
 Board* Board_getPossibleBoard(Board* board, PossibleMove* possibleMove){
-	Board* possibleBoard = Board_new();
+	Board* possibleBoard = allocateBoard();
 	if (!possibleBoard){
 		return NULL;
 	}
@@ -270,21 +465,18 @@ Board* Board_getPossibleBoard(Board* board, PossibleMove* possibleMove){
  * @return: 1 if (player) has any possible moves on the (board) configuration, 0 otherwise
  */
 int Board_possibleMovesExist (Board* board, int player){
-	for (int x = 1; x <= Board_SIZE; x++){
-		for (int y = 1; y <= Board_SIZE; y++){
-			if (Board_getColor(board, x, y) != player){
-				continue;
-			}
-			LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(board, x, y, 0);
-			if (!pieceMoves){
-				return -1; 
-			}
-			if (LinkedList_length(pieceMoves) > 0){
-				PossibleMoveList_free(pieceMoves);
-				return 1;
-			}
+	uint64_t pieces = board->occupied[player];
+	while (pieces){
+		int square = popSquare(&pieces);
+		LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(board, Board_FILE(square), Board_RANK(square), 0);
+		if (!pieceMoves){
+			return -1; 
+		}
+		if (LinkedList_length(pieceMoves) > 0){
 			PossibleMoveList_free(pieceMoves);
+			return 1;
 		}
+		PossibleMoveList_free(pieceMoves);
 	}
 	return 0;
 }
@@ -296,28 +488,139 @@ int Board_possibleMovesExist (Board* board, int player){
  *			(color) - the color of the player the scoring function is adjusted for.
  */
 int Board_evalPiece(Board* board, int x, int y, int player){
-	char piece = Board_getPiece(board, x, y);
-	int value = 0;
-	switch (piece){
-		case Board_BLACK_PAWN:   value = -1;   break;
-		case Board_WHITE_PAWN:   value =  1;   break;
-		case Board_BLACK_BISHOP: value = -3;   break;
-		case Board_WHITE_BISHOP: value =  3;   break;
-		case Board_BLACK_ROOK:   value = -5;   break;
-		case Board_WHITE_ROOK:   value =  5;   break;
-		case Board_BLACK_QUEEN:  value = -9;   break;
-		case Board_WHITE_QUEEN:  value =  9;   break;
-		case Board_BLACK_KNIGHT: value = -3;   break;
-		case Board_WHITE_KNIGHT: value =  3;   break;
-		case Board_BLACK_KING:	 value = -400; break;
-		case Board_WHITE_KING:   value =  400; break;
-	}
+	int value = Board_VALUE_OF(Board_getPiece(board, x, y));
 	if (player == BLACK){
 		return -value;
 	}
 	return value;
 }
 
+/*
+ * @return: the material on the board, positive when it favours white, summed piece by piece
+ */
+static int getMaterialLoop(Board* board){
+	int material = 0;
+	uint64_t pieces = board->occupied[WHITE] | board->occupied[BLACK];
+	while (pieces){
+		material += Board_VALUE_OF(getCode(board, popSquare(&pieces)));
+	}
+	return material;
+}
+
+#ifdef MATERIAL_SIMD
+/*
+ * Byte lookup tables from a piece code to its value, indexed by all 16 codes so that a single shuffle
+ * looks up 16 squares at once. The king's value does not fit in a byte, so kings are counted in a table
+ * of their own. Every entry is biased by MATERIAL_BIAS to make it unsigned, which the sum of absolute 
+ * differences needs; the bias of all 64 squares is taken off the sums. Filled in by Board_initMaterial.
+ */
+#define MATERIAL_BIAS 16
+
+static unsigned char materialTable[16] __attribute__((aligned(16)));
+static unsigned char kingTable[16] __attribute__((aligned(16)));
+
+/*
+ * @return: the material on the board, positive when it favours white, 
+ *          given the sums of the biased material and king lookups of all its squares
+ */
+static int combineMaterialSums(int materialSum, int kingSum){
+	int bias = MATERIAL_BIAS*Board_SIZE*Board_SIZE;
+	return (materialSum - bias) + (kingSum - bias)*Board_VALUE_OF(Board_WHITE_KING);
+}
+
+/*
+ * The material summed 16 squares at a time with SSSE3.
+ */
+__attribute__((target("ssse3")))
+static int getMaterialSsse3(Board* board){
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	const __m128i materials = _mm_load_si128((const __m128i*)materialTable);
+	const __m128i kings = _mm_load_si128((const __m128i*)kingTable);
+	__m128i materialSums = zero;
+	__m128i kingSums = zero;
+	for (int half = 0; half < 2; half++){
+		__m128i pairs = _mm_loadu_si128((const __m128i*)(board->squares + 16*half));
+		__m128i codes[2] = {_mm_and_si128(pairs, nibbleMask), _mm_and_si128(_mm_srli_epi16(pairs, 4), nibbleMask)};
+		for (int i = 0; i < 2; i++){
+			materialSums = _mm_add_epi64(materialSums, _mm_sad_epu8(_mm_shuffle_epi8(materials, codes[i]), zero));
+			kingSums = _mm_add_epi64(kingSums, _mm_sad_epu8(_mm_shuffle_epi8(kings, codes[i]), zero));
+		}
+	}
+	int materialSum = _mm_cvtsi128_si32(materialSums) + _mm_cvtsi128_si32(_mm_srli_si128(materialSums, 8));
+	int kingSum = _mm_cvtsi128_si32(kingSums) + _mm_cvtsi128_si32(_mm_srli_si128(kingSums, 8));
+	return combineMaterialSums(materialSum, kingSum);
+}
+
+/*
+ * The material summed 32 squares at a time with AVX2.
+ */
+__attribute__((target("avx2")))
+static int getMaterialAvx2(Board* board){
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+	const __m256i materials = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)materialTable));
+	const __m256i kings = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)kingTable));
+	__m256i pairs = _mm256_loadu_si256((const __m256i*)board->squares);
+	__m256i low = _mm256_and_si256(pairs, nibbleMask);
+	__m256i high = _mm256_and_si256(_mm256_srli_epi16(pairs, 4), nibbleMask);
+	__m256i materialSums = _mm256_add_epi64(_mm256_sad_epu8(_mm256_shuffle_epi8(materials, low), zero),
+			_mm256_sad_epu8(_mm256_shuffle_epi8(materials, high), zero));
+	__m256i kingSums = _mm256_add_epi64(_mm256_sad_epu8(_mm256_shuffle_epi8(kings, low), zero),
+			_mm256_sad_epu8(_mm256_shuffle_epi8(kings, high), zero));
+	__m128i materialSum = _mm_add_epi64(_mm256_castsi256_si128(materialSums), _mm256_extracti128_si256(materialSums, 1));
+	__m128i kingSum = _mm_add_epi64(_mm256_castsi256_si128(kingSums), _mm256_extracti128_si256(kingSums, 1));
+	return combineMaterialSums(_mm_cvtsi128_si32(materialSum) + _mm_cvtsi128_si32(_mm_srli_si128(materialSum, 8)),
+			_mm_cvtsi128_si32(kingSum) + _mm_cvtsi128_si32(_mm_srli_si128(kingSum, 8)));
+}
+#endif
+
+/* the material function used by the scoring functions, chosen by Board_initMaterial */
+static Board_MaterialFunction getMaterial = getMaterialLoop;
+
+/*
+ * @return: the function summing the material with (implementation),
+ *          NULL if this processor or compiler does not support it
+ */
+Board_MaterialFunction Board_getMaterialFunction(int implementation){
+	switch (implementation){
+		case Board_MATERIAL_LOOP: return getMaterialLoop;
+#ifdef MATERIAL_SIMD
+		case Board_MATERIAL_SSSE3: return (__builtin_cpu_supports("ssse3"))? getMaterialSsse3: NULL;
+		case Board_MATERIAL_AVX2: return (__builtin_cpu_supports("avx2"))? getMaterialAvx2: NULL;
+#endif
+		default: return NULL;
+	}
+}
+
+/*
+ * Chooses the fastest material function this processor supports.
+ */
+void Board_initMaterial(){
+#ifdef MATERIAL_SIMD
+	__builtin_cpu_init();
+	for (int code = 0; code < 16; code++){
+		int isKing = Board_pieceType[code] == Board_KING;
+		materialTable[code] = MATERIAL_BIAS + ((isKing)? 0: Board_pieceValue[code]);
+		kingTable[code] = MATERIAL_BIAS + ((isKing)? Board_pieceValue[code]/Board_VALUE_OF(Board_WHITE_KING): 0);
+	}
+#endif
+	for (int implementation = Board_MATERIAL_AVX2; implementation >= Board_MATERIAL_LOOP; implementation--){
+		Board_MaterialFunction function = Board_getMaterialFunction(implementation);
+		if (function){
+			getMaterial = function;
+			return;
+		}
+	}
+}
+
+/*
+ * @return: the material on the board, positive when it favours white
+ */
+int Board_getMaterial(Board* board){
+	return getMaterial(board);
+}
+
 /*
  * Evaluates the board according to the specified scoring function.
  *
@@ -330,24 +633,110 @@ int Board_getScore(Board* board, int scoredForPlayer, int nextPlayer){
 		return -10001;
 	}
 	if (Board_isInCheck(board, nextPlayer) && !nextPlayerCanMove){
-		return scoredForPlayer == nextPlayer? -10000: 10000;
+		return scoredForPlayer == nextPlayer? -Board_MATE: Board_MATE;
 	}
 	//tie
 	if (!nextPlayerCanMove){
 		return 0;
 	}
 	//otherwise
+	int score = getMaterial(board);
+	return (scoredForPlayer == BLACK)? -score: score;
+}
+
+#define PAWN_HASH_SIZE (1 << 14)
+#define FILE_MASK(file) ((uint64_t)0x0101010101010101ULL << (file))
+#define ISOLATED_PAWN_PENALTY 2
+#define DOUBLED_PAWN_PENALTY  2
+
+/* by the number of rows the pawn has advanced from its player's home row */
+static const int passedPawnBonus[Board_SIZE] = {0, 0, 1, 2, 3, 5, 8, 0};
+
+/*
+ * The pawn structure scores of recently evaluated positions, indexed by the low bits of their pawn key.
+ * The pawns of a position rarely change during a search, so their score is rarely computed again.
+ */
+typedef struct PawnHashEntry{
+	uint32_t pawnKey;
+	int score;
+} PawnHashEntry;
+
+static PawnHashEntry pawnHash[PAWN_HASH_SIZE];
+static long pawnHashProbes;
+static long pawnHashHits;
+
+/*
+ * Scores the pawns of (player): a bonus for each passed pawn, growing as it advances,
+ * and penalties for isolated pawns and for pawns doubled on the same column.
+ */
+static int getPawnsScore(uint64_t ownPawns, uint64_t enemyPawns, int player){
 	int score = 0;
-	for (int x = 1; x <= Board_SIZE; x++){
-		for (int y = 1; y <= Board_SIZE; y++){
-			score += Board_evalPiece(board, x, y, scoredForPlayer);
+	uint64_t pawns = ownPawns;
+	while (pawns){
+		int square = popSquare(&pawns);
+		int file = square % Board_SIZE;
+		int rank = square / Board_SIZE;
+		uint64_t adjacentFiles = ((file > 0)? FILE_MASK(file-1): 0) | ((file < Board_SIZE-1)? FILE_MASK(file+1): 0);
+		if (!(ownPawns & adjacentFiles)){
+			score -= ISOLATED_PAWN_PENALTY;
+		}
+		uint64_t ahead;
+		if (player == WHITE){
+			ahead = (rank < Board_SIZE-1)? ~(uint64_t)0 << (Board_SIZE*(rank+1)): 0;
+		}
+		else{
+			ahead = (rank > 0)? ~(uint64_t)0 >> (Board_SIZE*(Board_SIZE-rank)): 0;
+		}
+		if (!(enemyPawns & ahead & (FILE_MASK(file) | adjacentFiles))){
+			score += passedPawnBonus[(player == WHITE)? rank: Board_SIZE-1-rank];
+		}
+	}
+	for (int file = 0; file < Board_SIZE; file++){
+		int pawnsOnFile = __builtin_popcountll(ownPawns & FILE_MASK(file));
+		if (pawnsOnFile > 1){
+			score -= DOUBLED_PAWN_PENALTY*(pawnsOnFile-1);
 		}
 	}
 	return score;
 }
 
 /*
- * Evaluates the board according to a slightly better scoring function.
+ * @return: the pawn structure score of (board), positive when it favours white
+ */
+static int getPawnStructureScore(Board* board){
+	PawnHashEntry* entry = &pawnHash[board->pawnKey & (PAWN_HASH_SIZE-1)];
+	pawnHashProbes++;
+	if (entry->pawnKey == board->pawnKey){
+		pawnHashHits++;
+		return entry->score;
+	}
+	uint64_t pawns[2] = {0, 0};
+	for (int player = BLACK; player <= WHITE; player++){
+		uint64_t pieces = board->occupied[player];
+		while (pieces){
+			int square = popSquare(&pieces);
+			if (Board_TYPE_OF(getCode(board, square)) == Board_PAWN){
+				pawns[player] |= BIT(square);
+			}
+		}
+	}
+	entry->pawnKey = board->pawnKey;
+	entry->score = getPawnsScore(pawns[WHITE], pawns[BLACK], WHITE) - getPawnsScore(pawns[BLACK], pawns[WHITE], BLACK);
+	return entry->score;
+}
+
+/*
+ * @params: (probes) - set to the number of times a pawn structure score was needed,
+ *          (hits) - set to the number of times it was found in the pawn hash
+ */
+void Board_getPawnHashStats(long* probes, long* hits){
+	*probes = pawnHashProbes;
+	*hits = pawnHashHits;
+}
+
+/*
+ * Evaluates the board according to a slightly better scoring function,
+ * which adds mobility and pawn structure to the material.
  *
  * @return: a numeric evaluation of the board
  */
@@ -368,7 +757,7 @@ int Board_getBetterScore(Board* board, int scoredForPlayer, int nextPlayer){
 	if (Board_isInCheck(board, nextPlayer) && !nextPlayerCanMove){
 		LinkedList_free(playerMoves);
 		LinkedList_free(otherPlayerMoves);
-		return scoredForPlayer == nextPlayer? -10000: 10000;
+		return scoredForPlayer == nextPlayer? -Board_MATE: Board_MATE;
 	}
 	//tie
 	if (!nextPlayerCanMove){
@@ -377,12 +766,9 @@ int Board_getBetterScore(Board* board, int scoredForPlayer, int nextPlayer){
 		return 0;
 	}
 	//otherwise
-	int score = LinkedList_length(playerMoves) - LinkedList_length(otherPlayerMoves);
-	for (int x = 1; x <= Board_SIZE; x++){
-		for (int y = 1; y <= Board_SIZE; y++){
-			score += 10*Board_evalPiece(board, x, y, scoredForPlayer);
-		}
-	}
+	int whiteAdvantage = 10*getMaterial(board) + getPawnStructureScore(board);
+	int score = LinkedList_length(playerMoves) - LinkedList_length(otherPlayerMoves)
+			+ ((scoredForPlayer == BLACK)? -whiteAdvantage: whiteAdvantage);
 	
 	LinkedList_free(playerMoves);
 	LinkedList_free(otherPlayerMoves);
@@ -390,36 +776,16 @@ int Board_getBetterScore(Board* board, int scoredForPlayer, int nextPlayer){
 	return score;
 }
 
-static int getApproxNumOfMovesPerPiece(Board* board, int x, int y, int player){
-	int color = Board_getColor(board, x, y);
-	if (color != player){
-		return 0;
-	}
-	char piece = Board_getPiece(board, x, y);
-	int value = 0;
-	switch (piece){
-		case Board_BLACK_PAWN:
-		case Board_WHITE_PAWN:   value =  2; break;
-		case Board_BLACK_BISHOP:
-		case Board_WHITE_BISHOP: value =  7; break;
-		case Board_BLACK_ROOK:
-		case Board_WHITE_ROOK:   value =  7; break;
-		case Board_BLACK_QUEEN:
-		case Board_WHITE_QUEEN:  value = 14; break;
-		case Board_BLACK_KNIGHT:
-		case Board_WHITE_KNIGHT: value =  8; break;
-		case Board_BLACK_KING:
-		case Board_WHITE_KING:   value =  8; break;
-	}
-	return value;
-}
+/* 
+ * A rough upper bound on the number of moves of each piece type.
+ */
+static const int approxNumOfMovesPerType[7] = {0, 2, 8, 7, 7, 14, 8};
 
 int Board_getUpperBoundMoves(Board* board, int player){
 	int bound = 0;
-	for (int x = 1; x <= Board_SIZE; x++){
-		for (int y = 1; y <= Board_SIZE; y++){
-			bound += getApproxNumOfMovesPerPiece(board, x, y, player);
-		}
+	uint64_t pieces = board->occupied[player];
+	while (pieces){
+		bound += approxNumOfMovesPerType[Board_TYPE_OF(getCode(board, popSquare(&pieces)))];
 	}
 	return bound;
 }
@@ -427,139 +793,57 @@ int Board_getUpperBoundMoves(Board* board, int player){
 
 
 /*
- * Checks if the player's king can be captured by an enemy pawn.
- * @params: (board) - the board to be checked
- *		    (player) - the player whose king is checked for possible captures
- *
- * @return: 1 if the player's king can be captured by an enemy pawn, 0 otherwise
- */
-static int canBeCapturedByAPawn(Board* board, int player){
-	char enemyPawn = (player == BLACK)? Board_WHITE_PAWN: Board_BLACK_PAWN;
-	int forward = (player == BLACK)? -1 : 1;
-	int x = board->kingX[player];
-	int y = board->kingY[player];
-	for (int i = -1; i <= 1; i += 2){
-		if (Board_isInRange(x+i, y+forward)){
-			if (Board_getPiece(board, x+i, y+forward) == enemyPawn){
-				return 1;
-			}
-		}
-	}
-	return 0;
-}
+ * The squares attacked from each square by a knight, by a king and by a pawn of each player,
+ * as sets of bits indexed by square. Filled in by Board_initAttackTables.
+ */
+static uint64_t knightAttacks[Board_SIZE*Board_SIZE];
+static uint64_t kingAttacks[Board_SIZE*Board_SIZE];
+static uint64_t pawnAttacks[2][Board_SIZE*Board_SIZE];
+
+static const int knightOffsets[8][2] = {{-1,-2}, {1,-2}, {-2,-1}, {2,-1}, {-2,1}, {2,1}, {-1,2}, {1,2}};
+static const int kingOffsets[8][2]   = {{-1,-1}, {0,-1}, {1,-1}, {-1,0}, {1,0}, {-1,1}, {0,1}, {1,1}};
 
 /*
- * Checks if the player's king can be captured by an enemy knight.
- * @params: (board) - the board to be checked
- *		    (player) - the player whose king is checked for possible captures
- *
- * @return: 1 if the player's king can be captured by an enemy knight, 0 otherwise
- */
-static int canBeCapturedByAKnight(Board* board, int player){
-	char enemyKnight = (player == BLACK)? Board_WHITE_KNIGHT: Board_BLACK_KNIGHT;
-	int x = board->kingX[player];
-	int y = board->kingY[player];
-	for (int sideward = -1; sideward <= 1; sideward+=2){
-		for (int forward = -2; forward <= 2; forward+=4){
-			if (Board_isInRange(x+sideward, y+forward)){
-				if (Board_getPiece(board, x+sideward, y+forward) == enemyKnight){
-					return 1;
-				}
-			}
-		}
-	}
-	for (int sideward = -2; sideward <= 2; sideward+=4){
-		for (int forward = -1; forward <= 1; forward+=2){
-			if (Board_isInRange(x+sideward, y+forward)){
-				if (Board_getPiece(board, x+sideward, y+forward) == enemyKnight){
-					return 1;
-				}
-			}
+ * @return: the set of squares reachable from (x, y) by the given (offsets) 
+ */
+static uint64_t getAttacks(int x, int y, const int offsets[][2], int numOfOffsets){
+	uint64_t attacks = 0;
+	for (int i = 0; i < numOfOffsets; i++){
+		if (Board_isInRange(x+offsets[i][0], y+offsets[i][1])){
+			attacks |= BIT(Board_SQUARE(x+offsets[i][0], y+offsets[i][1]));
 		}
 	}
-	return 0;
+	return attacks;
 }
 
 /*
- * Checks if the player's king can be captured by an enemy bishop, rook or queen.
- * @params: (board) - the board to be checked
- *		    (player) - the player whose king is checked for possible captures
- *
- * @return: 1 if the player's king can be captured by an enemy knight, 0 otherwise
+ * Fills in the attack tables of knights, kings and pawns. 
+ * Must be called once before any moves are generated.
  */
-static int canBeCapturedByABishopRookOrQueen(Board* board, int player){
-	for (int sideward = -1; sideward <= 1; sideward++){
-		for (int forward = -1; forward <= 1; forward++){
-			for (int dist = 1; dist <= 7; dist++){
-				int x = board->kingX[player]+dist*sideward;
-				int y = board->kingY[player]+dist*forward;
-				
-				
-				if (!Board_isInRange(x, y)){
-					break;
-				}
-				if (Board_getColor(board, x, y) == player){
-					break;
-				}
-				if (Board_isEmpty(board, x, y)){
-					continue;
-				}
-				if (toupper(Board_getPiece(board, x, y)) != Board_BLACK_QUEEN &&
-					toupper(Board_getPiece(board, x, y)) != Board_BLACK_ROOK &&
-					toupper(Board_getPiece(board, x, y)) != Board_BLACK_BISHOP){
-					break;
-				}
-				
-				if (toupper(Board_getPiece(board, x, y)) == Board_BLACK_QUEEN){
-					return 1;
-				}
-				
-				if (toupper(Board_getPiece(board, x, y)) == Board_BLACK_ROOK){
-					if (forward == 0 || sideward == 0){
-						return 1;
-					}
-					break;
-				}
-				
-				if (toupper(Board_getPiece(board, x, y)) == Board_BLACK_BISHOP){
-					if (sideward != 0 && forward != 0){
-						return 1;
-					}
-					break;
-				}
-			}
+void Board_initAttackTables(){
+	static const int whitePawnOffsets[2][2] = {{-1,1}, {1,1}};
+	static const int blackPawnOffsets[2][2] = {{-1,-1}, {1,-1}};
+	for (int x = 1; x <= Board_SIZE; x++){
+		for (int y = 1; y <= Board_SIZE; y++){
+			int square = Board_SQUARE(x, y);
+			knightAttacks[square]     = getAttacks(x, y, knightOffsets, 8);
+			kingAttacks[square]       = getAttacks(x, y, kingOffsets, 8);
+			pawnAttacks[WHITE][square] = getAttacks(x, y, whitePawnOffsets, 2);
+			pawnAttacks[BLACK][square] = getAttacks(x, y, blackPawnOffsets, 2);
 		}
 	}
-	return 0;
 }
 
 /*
  * Checks if the player's king can be captured by the other player's king.
  * @params: (board) - the board to be checked
- *		    (player) - the player whose king is checked for possible captures
  *
- * @return: 1 if the player's king can be captured by the other player's king, 0 otherwise
+ * @return: 1 if the kings are adjacent to each other, 0 otherwise
  */
 static int canBeCapturedByAKing(Board* board){
-	return (abs(board->kingX[BLACK]-board->kingX[WHITE]) <= 1)
-		&& (abs(board->kingY[BLACK]-board->kingY[WHITE]) <= 1);
+	return (kingAttacks[board->kingSquare[WHITE]] & BIT(board->kingSquare[BLACK])) != 0;
 }
 
-/*
- * Checks if the board is now in "check" for a given player,
- * by checking whether their king is at risk of being captured.
- * @params: (board) - the board to be checked
- *		    (player) - the player whose king is checked for possible captures
- *
- * @return: 1 if the player's king can be captured by an enemy piece, 0 otherwise
- */
-int Board_isInCheck(Board* board, int player){	
-	return canBeCapturedByAPawn(board, player)
-		|| canBeCapturedByAKnight(board, player)
-		|| canBeCapturedByABishopRookOrQueen(board, player)
-		|| canBeCapturedByAKing(board);
-}	
-
 /*
  * Checks if a given row is the furthest row for the given player.
  *
@@ -576,421 +860,212 @@ int Board_isFurthestRowForPlayer (int player, int y){
 }
 
 /*
- * Gets all possible moves for a given pawn piece on a given board.
- * 
- * @params: (board) - a pointer to the relevant board
- *          (fromX, fromY) - location of the relevant pawn on (board)
+ * Checks if a clear horizontal path exists on (board) between (fromX, y) and (toX, y).
+ * That is, a path that is not occupied by any piece.
+ * @params: (board) - the board to be checked
+ *		    (fromX), (toX), (y) - the relevant coordinates on the board
  *
- * @return: A list of all possible moves for the relevant pawn.
+ * @return: 1 if such a path exists, 0 otherwise
  */
-static LinkedList* getPawnMoves(Board* board, int fromX, int fromY){
-	int player = Board_getColor(board, fromX, fromY);
-	char* promotionOptions = (player == WHITE)? 
-			(char[4]){'q', 'b', 'n', 'r'}: (char[4]){'Q', 'B', 'N', 'R'};
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	
-	if (!possibleMoves){
-		return NULL;
-	}
-	
-	int forward = (player == WHITE)? 1: -1;
-	for (int sideward = -1; sideward <= 1; sideward++){
-		int toX = fromX+sideward;
-		int toY = fromY+forward;
-		char enemyKing = (player == WHITE)? 'K' : 'k';
-		if (!Board_isInRange(toX, toY)){
-			continue;
-		}
-		// the enemy king is never actually captured
-		if (Board_getPiece(board, toX, toY) == enemyKing){
-			continue;
-		}
-		
-		int canMoveForward = Board_isEmpty(board, toX, toY) && sideward == 0;
-		int canCapture = (Board_getColor(board, toX, toY) == !player) && (sideward != 0);
-		if (canMoveForward || canCapture){
-			if (Board_isFurthestRowForPlayer(player, toY)){	
-				for (int i = 0; i <= 3; i++){  //generate all possible promotions
-					PossibleMove* newMove1 = PossibleMove_new(fromX, fromY, toX, toY, promotionOptions[i], board);
-					if (!newMove1){
-						PossibleMoveList_free(possibleMoves);
-						return NULL;
-					}
-					if (!Board_isInCheck(newMove1->board, player)){
-						if(LinkedList_add(possibleMoves, newMove1)){
-							PossibleMoveList_free(possibleMoves);
-							return NULL;
-						}
-					}
-					else{
-						PossibleMove_free(newMove1);
-					}
-				}
-			}	
-			else{
-				PossibleMove* newMove2 = PossibleMove_new(fromX, fromY, toX, toY, 0, board);
-				if (!newMove2){
-					PossibleMoveList_free(possibleMoves);
-					return NULL;
-				}
-				if (!Board_isInCheck(newMove2->board, player)){
-					if(LinkedList_add(possibleMoves, newMove2)){
-						PossibleMoveList_free(possibleMoves);
-						return NULL;
-					}
-				}
-				else{
-					PossibleMove_free(newMove2);
-				}
-			}
+int Board_clearHorizontalPathExists(Board* board, int fromX, int toX, int y){
+	int adjustment = (toX < fromX)? -1 : 1;
+	for (int x = fromX+adjustment; x != toX; x += adjustment){
+		if (!Board_isEmpty(board, x, y)){
+			return 0;
 		}
 	}
-	return possibleMoves;
+	return 1;
 }
 
-/*
- * Adds a single possible move from (fromX, fromY) to (fromX+sideward, fromY+forward)
- * to (possibleMoves) if  this move is legal.
- *
- * @return: -1 if the given position is occupied or out of range,
- *		    -2 if an allocation error occured
- *           0 otherwise
+/* 
+ * The move generator and check detection, compiled once for each player.
  */
-int addMoveIfLegal(LinkedList* possibleMoves, Board* board, 
-			int fromX, int fromY, int sideward, int forward){
-	int player = Board_getColor(board, fromX, fromY);
-	int toX = fromX + sideward;
-	int toY = fromY + forward;
-	char enemyKing = (player == WHITE)? 'K' : 'k';
-	if (!Board_isInRange(toX, toY)){
-		return -1;
-	}
-	if (Board_getColor(board, toX, toY) == player){
-		return -1;
-	}
-	// the enemy king is never actually captured
-	if (Board_getPiece(board, toX, toY) == enemyKing){
-		return -1;
-	}
-	PossibleMove* move = PossibleMove_new(fromX, fromY, toX, toY, 0, board);
-	if (!move){
-		return -2;
-	}
-	if (!Board_isInCheck(move->board, player)){
-		if(LinkedList_add(possibleMoves, move)){
-			return -2;
-		}
-	}
-	else {
-		PossibleMove_free(move);
-	}
-	
-	if (!Board_isEmpty(board, toX, toY)){
-		return -1;
-	}			
-	return 0;
-}
+#define PLAYER WHITE
+#define COLORED(name) name##White
+#include "BoardColored.h"
+#undef PLAYER
+#undef COLORED
+
+#define PLAYER BLACK
+#define COLORED(name) name##Black
+#include "BoardColored.h"
+#undef PLAYER
+#undef COLORED
 
 /*
- * Gets all possible moves for a given bishop piece on a given board.
+ * Checks if the board is now in "check" for a given player,
+ * by checking whether their king is at risk of being captured.
+ * @params: (board) - the board to be checked
+ *		    (player) - the player whose king is checked for possible captures
  *
- * @return: A list of all possible moves for a bishop located at (fromX, fromY) on (board)       
+ * @return: 1 if the player's king can be captured by an enemy piece, 0 otherwise
  */
-static LinkedList* getBishopMoves(Board* board, int fromX, int fromY){
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
-	}
-	for (int sideward = -1; sideward <= 1; sideward += 2){
-		for (int forward = -1; forward <= 1; forward += 2){
-			for (int dist = 1; dist < Board_SIZE; dist++){
-				int cantMoveFurther = addMoveIfLegal(possibleMoves, board, fromX, fromY, dist*sideward, dist*forward);
-				if(cantMoveFurther == -2){
-					return NULL;
-				}
-				if (cantMoveFurther == -1){
-					break;
-				}
-			}
-		}
-	}
-	return possibleMoves;
+int Board_isInCheck(Board* board, int player){
+	return (player == WHITE)? isInCheckWhite(board): isInCheckBlack(board);
 }
 
 /*
- * Checks if a clear and safe horizontal path exists on (board) between (fromX, y) and (toX, y).
- * That is, a path that is not occupied by any piece, and if the king would move from (fromX, y) to (toX, y),
- * at no point will it be under attack.
- * @params: (board) - the board to be checked
- *		    (fromX), (toX), (y) - the relevant coordinates on the board
+ * General function for getting all possible moves for a given piece on a given board.
  *
- * @return: 1 if such a path exists, 0 otherwise
+ * @return: A list of all possible moves for a piece located at (fromX, fromY) on (board)       
  */
-int Board_clearAndSafeHorizontalPathExistsForKing(Board* board, int fromX, int toX, int y){
-	int exitcode = 1;
-	int player = Board_getColor(board, fromX, y);
-	int adjustment = (toX < fromX)? -1 : 1;
-	
-	for (int i = 1; i <= 2; i++){
-		if(!Board_isEmpty(board, fromX+i*adjustment, y)){
-			exitcode = 0;
-			break;
-		}
-		PossibleMove* step = PossibleMove_new(fromX+(i-1)*adjustment, y, fromX+adjustment*i, y, 0, board);
-		if(!step){
-			return -1;
-		}
-		if(Board_isInCheck(step->board, player)){
-			exitcode = 0;
-			PossibleMove_free(step);
-			break;
-		}
-		PossibleMove_free(step);
+LinkedList* Board_getPossibleMovesOfPiece(Board* board, int x, int y, int alreadyGotCastlingMoves){
+	switch (Board_getColor(board, x, y)){
+		case WHITE: return getPossibleMovesOfPieceWhite(board, x, y, alreadyGotCastlingMoves, Board_ALL_KINDS, ~(uint64_t)0);
+		case BLACK: return getPossibleMovesOfPieceBlack(board, x, y, alreadyGotCastlingMoves, Board_ALL_KINDS, ~(uint64_t)0);
 	}
-	return exitcode;
+	return PossibleMoveList_new();
 }
 
 /*
- * Checks if a clear horizontal path exists on (board) between (fromX, y) and (toX, y).
- * That is, a path that is not occupied by any piece.
- * @params: (board) - the board to be checked
- *		    (fromX), (toX), (y) - the relevant coordinates on the board
+ * Main function for getting all of the moves currently possible for a player. 
  *
- * @return: 1 if such a path exists, 0 otherwise
+ * @params: (player) - the player whose moves are to be put in the list
+ * @return: a list of all moves currently possible for the player, or NULL if any allocation errors occurred 
  */
-int Board_clearHorizontalPathExists(Board* board, int fromX, int toX, int y){
-	int adjustment = (toX < fromX)? -1 : 1;
-	for (int x = fromX+adjustment; x != toX; x += adjustment){
-		if (!Board_isEmpty(board, x, y)){
-			return 0;
-		}
-	}
-	return 1;
-}
-
-static LinkedList* getCastlingMoves(Board* board, int x, int y){
-	int player = Board_getColor(board, x, y);
-	int legalY = (player == WHITE)? 1 : 8;
-	
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
-	}
-	if ((!pieceIsRook(board, x, y))
-		|| (y != legalY) 
-		|| (board->hasKingEverMoved[player])
-		|| (Board_isInCheck(board, player))
-		|| (board->hasRookEverMoved[player][0] && board->hasRookEverMoved[player][1])){	
-		return possibleMoves; //empty list
-	}
-	int kingDestX = (x == 1)? 3 : 7;
-	int positionInRookMovementArray = (x == 1)? 0 : 1;
-	int clearPathExistsForKing = Board_clearAndSafeHorizontalPathExistsForKing(board, 5, kingDestX, y);
-	if (clearPathExistsForKing == -1){
-		PossibleMoveList_free(possibleMoves);
-		return NULL;
-	}
-	
-	if (Board_clearHorizontalPathExists(board, 5, x, y) 
-		&& clearPathExistsForKing 
-		&& board->hasRookEverMoved[player][positionInRookMovementArray] == 0){
-		PossibleMove* newCastlingMove = PossibleMove_new(x, y, 0, 0, 0, board);
-		if(!newCastlingMove){
-			PossibleMoveList_free(possibleMoves);
-			return NULL;
-		}
-		if(LinkedList_add(possibleMoves, newCastlingMove)){
-			PossibleMoveList_free(possibleMoves);
-			return NULL;
-		}
-	}
-	return possibleMoves;
+LinkedList* Board_getPossibleMoves(Board* board, int player){
+	return Board_getPossibleMovesOfKinds(board, player, Board_ALL_KINDS);
 }
 
 /*
- * Gets all possible moves for a given rook piece on a given board.
+ * Gets the moves currently possible for a player, of the given kinds only.
  *
- * @return: A list of all possible moves for a rook located at (fromX, fromY) on (board)       
+ * @params: (kinds) - Board_CAPTURES for captures and promotions, Board_QUIETS for all other moves,
+ *                    or both
+ * @return: a list of the possible moves, or NULL if any allocation errors occurred 
  */
-static LinkedList* getRookMoves(Board* board, int fromX, int fromY, int calledForQueen, int alreadyGotCastlingMoves){
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
-	}
-	for (int sideward = -1; sideward <= 1; sideward += 2){
-		for (int dist = 1; dist < Board_SIZE; dist++){
-			int cantMoveFurther = addMoveIfLegal(possibleMoves, board, fromX, fromY, sideward*dist, 0);
-			if (cantMoveFurther == -2){
-				return NULL;
-			}
-			if (cantMoveFurther == -1){
-				break;
-			}
-		}
-	}
-	for (int forward = -1; forward <= 1; forward += 2){
-		for (int dist = 1; dist < Board_SIZE; dist++){
-			int cantMoveFurther = addMoveIfLegal(possibleMoves, board, fromX, fromY, 0, forward*dist);
-			if (cantMoveFurther == -2){
-				return NULL;
-			}
-			if (cantMoveFurther == -1){
-				break;
-			}
-		}
-	}
-	if (!calledForQueen && !alreadyGotCastlingMoves){
-		LinkedList* castlingMoves = getCastlingMoves(board, fromX, fromY);
-		if (!castlingMoves){
-			PossibleMoveList_free(possibleMoves);
-			return NULL;
-		}
-		LinkedList_concatenateAndFree(possibleMoves, castlingMoves);
-	}
-	return possibleMoves;
+LinkedList* Board_getPossibleMovesOfKinds(Board* board, int player, int kinds){
+	return (player == WHITE)? getPossibleMovesWhite(board, kinds): getPossibleMovesBlack(board, kinds);
 }
 
 /*
- * Gets all possible moves for a given queen piece on a given board.
+ * Gets the moves possible for a player whose king is in check. 
+ * Only moves that may get the king out of check are generated.
  *
- * @return: A list of all possible moves for a queen located at (fromX, fromY) on (board)       
+ * @return: a list of the possible moves, or NULL if any allocation errors occurred 
  */
-static LinkedList* getQueenMoves(Board* board, int fromX, int fromY, int alreadyGotCastlingMoves){
-	LinkedList* possibleMoves1;
-	LinkedList* possibleMoves2;
-	possibleMoves1 = getBishopMoves(board, fromX, fromY);
-	if (!possibleMoves1){
-		return NULL;
-	}
-	possibleMoves2 = getRookMoves  (board, fromX, fromY, 1, alreadyGotCastlingMoves);
-	if (!possibleMoves2){
-		PossibleMoveList_free(possibleMoves1);
-		return NULL;
-	}
-	
-	LinkedList_concatenateAndFree(possibleMoves1, possibleMoves2);
-	return possibleMoves1;
+LinkedList* Board_getEvasions(Board* board, int player){
+	return (player == WHITE)? getEvasionsWhite(board): getEvasionsBlack(board);
 }
 
 /*
- * Gets all possible moves for a given knight piece on a given board.
+ * Finds the pieces of both players attacking (square), 
+ * as if only the pieces standing on (occupied) were on the board.
  *
- * @return: A list of all possible moves for a knight located at (fromX, fromY) on (board)       
+ * @return: the squares of the attacking pieces
  */
-static LinkedList* getKnightMoves(Board* board, int fromX, int fromY){
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
+static uint64_t getAttackers(Board* board, int square, uint64_t occupied){
+	uint64_t attackers = 0;
+	uint64_t candidates = pawnAttacks[WHITE][square] & occupied;
+	while (candidates){
+		int from = popSquare(&candidates);
+		if (getCode(board, from) == Board_BLACK_PAWN){
+			attackers |= BIT(from);
+		}
 	}
-	for (int sideward = -1; sideward <= 1; sideward += 2){
-		for (int forward = -2; forward <= 2; forward += 4){
-			int error = addMoveIfLegal(possibleMoves, board, fromX, fromY, sideward, forward);
-			if (error == -2){
-				return NULL;
-			}
+	candidates = pawnAttacks[BLACK][square] & occupied;
+	while (candidates){
+		int from = popSquare(&candidates);
+		if (getCode(board, from) == Board_WHITE_PAWN){
+			attackers |= BIT(from);
+		}
+	}
+	candidates = knightAttacks[square] & occupied;
+	while (candidates){
+		int from = popSquare(&candidates);
+		if (Board_TYPE_OF(getCode(board, from)) == Board_KNIGHT){
+			attackers |= BIT(from);
 		}
 	}
-	for (int sideward = -2; sideward <= 2; sideward += 4){
-		for (int forward = -1; forward <= 1; forward += 2){
-			int error = addMoveIfLegal(possibleMoves, board, fromX, fromY, sideward, forward);
-			if (error == -2){
-				return NULL;
+	candidates = kingAttacks[square] & occupied;
+	while (candidates){
+		int from = popSquare(&candidates);
+		if (Board_TYPE_OF(getCode(board, from)) == Board_KING){
+			attackers |= BIT(from);
+		}
+	}
+	for (int sideward = -1; sideward <= 1; sideward++){
+		for (int forward = -1; forward <= 1; forward++){
+			if (sideward == 0 && forward == 0){
+				continue;
+			}
+			int x = Board_FILE(square)+sideward;
+			int y = Board_RANK(square)+forward;
+			while (Board_isInRange(x, y) && !(occupied & BIT(Board_SQUARE(x, y)))){
+				x += sideward;
+				y += forward;
+			}
+			if (!Board_isInRange(x, y)){
+				continue;
+			}
+			int type = Board_TYPE_OF(Board_getPiece(board, x, y));
+			int straight = (sideward == 0 || forward == 0);
+			if (type == Board_QUEEN || (type == Board_ROOK && straight) || (type == Board_BISHOP && !straight)){
+				attackers |= BIT(Board_SQUARE(x, y));
 			}
 		}
 	}
-	return possibleMoves;
+	return attackers;
 }
 
 /*
- * Gets all possible moves for a given king piece on a given board.
+ * Resolves the exchange of pieces on (toX, toY) started by moving the piece on (fromX, fromY) there,
+ * assuming both players keep recapturing with their least valuable piece for as long as it pays off.
+ * Pinned pieces are assumed to be free to capture.
+ * Unless (exact) is set, the exchange stops being played out once its sign can no longer change.
  *
- * @return: A list of all possible moves for a king located at (fromX, fromY) on (board)       
+ * @return: the material won by the player making the move, negative if the exchange loses material
  */
-static LinkedList* getKingMoves(Board* board, int fromX, int fromY, int alreadyGotCastlingMoves){
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
-	}
-	for (int sideward = -1; sideward <= 1; sideward++){
-		for (int forward = -1; forward <= 1; forward++){
-			int error = addMoveIfLegal(possibleMoves, board, fromX, fromY, sideward, forward);
-			if (error == -2){
-				return NULL;
+static int getStaticExchange(Board* board, int fromX, int fromY, int toX, int toY, int exact){
+	int gain[32];
+	int depth = 0;
+	int square = Board_SQUARE(toX, toY);
+	uint64_t occupied = board->occupied[WHITE] | board->occupied[BLACK];
+	uint64_t attacker = BIT(Board_SQUARE(fromX, fromY));
+	int attackerValue = abs(Board_VALUE_OF(Board_getPiece(board, fromX, fromY)));
+	int player = Board_getColor(board, fromX, fromY);
+	gain[0] = abs(Board_VALUE_OF(getCode(board, square)));
+	while (attacker && depth < 31){
+		depth++;
+		gain[depth] = attackerValue - gain[depth-1]; // the score if the last capture is recaptured
+		if (!exact && -gain[depth-1] < 0 && gain[depth] < 0){  // the outcome can no longer change
+			break;
+		}
+		occupied &= ~attacker;
+		player = !player;
+		// revealed bishops, rooks and queens are found again as occupied shrinks
+		uint64_t attackers = getAttackers(board, square, occupied) & occupied & board->occupied[player];
+		attacker = 0;
+		int lowestValue = INT_MAX;
+		while (attackers){
+			int from = popSquare(&attackers);
+			int value = abs(Board_VALUE_OF(getCode(board, from)));
+			if (value < lowestValue){
+				lowestValue = value;
+				attacker = BIT(from);
 			}
 		}
+		attackerValue = lowestValue;
 	}
-	
-	if (!alreadyGotCastlingMoves){
-		LinkedList* castlingMoves1 = getCastlingMoves(board, 1, fromY);
-		if (!castlingMoves1){
-			PossibleMoveList_free(possibleMoves);
-			return NULL;
-		}
-		LinkedList_concatenateAndFree(possibleMoves, castlingMoves1);
-		
-		LinkedList* castlingMoves2 = getCastlingMoves(board, 8, fromY);
-		if (!castlingMoves2){
-			PossibleMoveList_free(possibleMoves);
-			return NULL;
-		}
-		LinkedList_concatenateAndFree(possibleMoves, castlingMoves2);
+	while (--depth > 0){
+		gain[depth-1] = -((-gain[depth-1] > gain[depth])? -gain[depth-1]: gain[depth]);
 	}
-	return possibleMoves;
+	return gain[0];
 }
 
 /*
- * General function for getting all possible moves for a given piece on a given board.
- *
- * @return: A list of all possible moves for a piece located at (fromX, fromY) on (board)       
+ * The static exchange evaluation of moving the piece on (fromX, fromY) to (toX, toY), see getStaticExchange.
+ * Only its sign is exact: once the sign is settled the exchange is cut short, so the value may be a bound.
  */
-LinkedList* Board_getPossibleMovesOfPiece(Board* board, int x, int y, int alreadyGotCastlingMoves){
-	char piece = Board_getPiece(board, x, y);
-	switch (piece){
-		case Board_BLACK_PAWN:
-		case Board_WHITE_PAWN:   return getPawnMoves  (board, x, y);
-		case Board_BLACK_BISHOP:
-		case Board_WHITE_BISHOP: return getBishopMoves(board, x, y);
-		case Board_BLACK_ROOK:
-		case Board_WHITE_ROOK:   return getRookMoves  (board, x, y, 0, alreadyGotCastlingMoves);
-		case Board_BLACK_QUEEN:
-		case Board_WHITE_QUEEN:  return getQueenMoves (board, x, y, alreadyGotCastlingMoves);
-		case Board_BLACK_KNIGHT:
-		case Board_WHITE_KNIGHT: return getKnightMoves(board, x, y);
-		case Board_BLACK_KING:
-		case Board_WHITE_KING: 	 return getKingMoves  (board, x, y, alreadyGotCastlingMoves);
-	}
-	return PossibleMoveList_new();
+int Board_getStaticExchange(Board* board, int fromX, int fromY, int toX, int toY){
+	return getStaticExchange(board, fromX, fromY, toX, toY, 0);
 }
 
 /*
- * Main function for getting all of the moves currently possible for a player. 
- *
- * @params: (player) - the player whose moves are to be put in the list
- * @return: a list of all moves currently possible for the player, or NULL if any allocation errors occurred 
+ * The static exchange evaluation of moving the piece on (fromX, fromY) to (toX, toY), played out to its end.
  */
-LinkedList* Board_getPossibleMoves(Board* board, int player){
-	int gotCastlingMoves = 0;
-	LinkedList* possibleMoves = PossibleMoveList_new();
-	if (!possibleMoves){
-		return NULL;
-	}
-	for (int x = 1; x <= Board_SIZE; x++){
-		for (int y = 1; y <= Board_SIZE; y++){
-			if (Board_getColor(board, x, y) != player){
-				continue;
-			}
-			if (pieceIsKing(board, x, y) || pieceIsRook(board, x, y)){
-				gotCastlingMoves = 1;
-			}
-			LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(board, x, y, gotCastlingMoves);
-			if (!pieceMoves){
-				PossibleMoveList_free(possibleMoves);
-				return NULL;
-			}
-			LinkedList_concatenateAndFree(possibleMoves, pieceMoves);
-		}
-	}
-	return possibleMoves;
+int Board_getExactStaticExchange(Board* board, int fromX, int fromY, int toX, int toY){
+	return getStaticExchange(board, fromX, fromY, toX, toY, 1);
 }
 
 /*
@@ -1012,7 +1087,7 @@ void Board_print(Board* board){
 	for (int y = Board_SIZE-1; y >= 0 ; y--){
 		printf("%d", y+1);
 		for (int x = 0; x < Board_SIZE; x++){
-			printf("| %c ", board->matrix[x][y]);
+			printf("| %c ", Board_pieceToChar(Board_getPiece(board, x+1, y+1)));
 		}
 		printf("|\n");
 		printLine();
@@ -4,24 +4,83 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#define Board_WHITE_PAWN   'm'
-#define Board_WHITE_BISHOP 'b'
-#define Board_WHITE_KNIGHT 'n'
-#define Board_WHITE_ROOK   'r'
-#define Board_WHITE_QUEEN  'q'
-#define Board_WHITE_KING   'k'
-
-#define Board_BLACK_PAWN   'M'
-#define Board_BLACK_BISHOP 'B'
-#define Board_BLACK_KNIGHT 'N'
-#define Board_BLACK_ROOK   'R'
-#define Board_BLACK_QUEEN  'Q'
-#define Board_BLACK_KING   'K'
-#define Board_EMPTY        ' '
+/*
+ * Pieces are 4-bit codes: the low three bits hold the piece type 
+ * and Board_BLACK_FLAG marks black pieces. 0 is an empty tile.
+ */
+#define Board_PAWN         1
+#define Board_KNIGHT       2
+#define Board_BISHOP       3
+#define Board_ROOK         4
+#define Board_QUEEN        5
+#define Board_KING         6
+#define Board_BLACK_FLAG   8
+
+#define Board_WHITE_PAWN   Board_PAWN
+#define Board_WHITE_BISHOP Board_BISHOP
+#define Board_WHITE_KNIGHT Board_KNIGHT
+#define Board_WHITE_ROOK   Board_ROOK
+#define Board_WHITE_QUEEN  Board_QUEEN
+#define Board_WHITE_KING   Board_KING
+
+#define Board_BLACK_PAWN   (Board_BLACK_FLAG | Board_PAWN)
+#define Board_BLACK_BISHOP (Board_BLACK_FLAG | Board_BISHOP)
+#define Board_BLACK_KNIGHT (Board_BLACK_FLAG | Board_KNIGHT)
+#define Board_BLACK_ROOK   (Board_BLACK_FLAG | Board_ROOK)
+#define Board_BLACK_QUEEN  (Board_BLACK_FLAG | Board_QUEEN)
+#define Board_BLACK_KING   (Board_BLACK_FLAG | Board_KING)
+#define Board_EMPTY        0
 #define Board_SIZE         8
+#define Board_MATE         10000
 #define BLACK 0
 #define WHITE 1
+#define QUEEN_SIDE 0
+#define KING_SIDE  1
 
+#define Board_SQUARE(x, y) (((y)-1)*Board_SIZE + (x)-1)
+#define Board_FILE(square) ((square)%Board_SIZE + 1)
+#define Board_RANK(square) ((square)/Board_SIZE + 1)
+/* the kinds of moves to generate, see Board_getPossibleMovesOfKinds */
+#define Board_CAPTURES  1
+#define Board_QUIETS    2
+#define Board_ALL_KINDS 3
+
+#define Board_MATERIAL_LOOP  0
+#define Board_MATERIAL_SSSE3 1
+#define Board_MATERIAL_AVX2  2
+
+#define Board_CASTLING_RIGHT(player, side) (1 << (2*(player) + (side)))
+#define Board_ALL_CASTLING_RIGHTS 0xF
+
+#define Board_PIECE(type, player) ((type) | (((player) == BLACK)? Board_BLACK_FLAG: 0))
+#define Board_COLOR_OF(piece) (Board_pieceColor[(unsigned char)(piece)])
+#define Board_TYPE_OF(piece)  (Board_pieceType[(unsigned char)(piece)])
+#define Board_VALUE_OF(piece) (Board_pieceValue[(unsigned char)(piece)])
+
+/* -1 for an empty tile, BLACK or WHITE otherwise */
+extern const signed char Board_pieceColor[16];
+
+/* the piece type without its color */
+extern const unsigned char Board_pieceType[16];
+
+/* material value, positive for white pieces and negative for black ones */
+extern const int Board_pieceValue[16];
+
+/* sums the material on a board, positive when it favours white */
+typedef int (*Board_MaterialFunction)(Board* board);
+
+char Board_pieceToChar(char piece);
+
+char Board_charToPiece(char ch);
+
+
+void Board_initAttackTables();
+
+void Board_initZobristKeys();
+
+void Board_initMaterial();
+
+void Board_setSideToMove(Board* board, int player);
 
 Board* Board_new();
 
@@ -51,6 +110,12 @@ int Board_getUpperBoundMoves(Board* board, int player);
 
 void Board_updateKingPosition (Board* board, int x, int y);
 
+int Board_hasKingEverMoved(Board* board, int player);
+
+int Board_hasRookEverMoved(Board* board, int player, int side);
+
+void Board_setCastlingHistory(Board* board, int hasKingEverMoved[2], int hasRookEverMoved[2][2]);
+
 int  Board_isInRange (int x, int y);
 
 void Board_update    (Board* board, PossibleMove* move);
@@ -59,16 +124,30 @@ Board* Board_getPossibleBoard(Board* board, PossibleMove* move);
 
 int Board_possibleMovesExist (Board* board, int player);
 
+int Board_getMaterial(Board* board);
+
+Board_MaterialFunction Board_getMaterialFunction(int implementation);
+
 int Board_getScore(Board* board, int scoredForPlayer, int nextPlayer);
 
 int Board_getBetterScore(Board* board, int scoredForPlayer, int nextPlayer);
 
+void Board_getPawnHashStats(long* probes, long* hits);
+
 int Board_isInCheck(Board* board, int player);
 
 LinkedList* Board_getPossibleMovesOfPiece(Board* board, int x, int y, int alreadyGotCastlingMoves);
 
 LinkedList* Board_getPossibleMoves(Board* board, int player);
 
+LinkedList* Board_getPossibleMovesOfKinds(Board* board, int player, int kinds);
+
+LinkedList* Board_getEvasions(Board* board, int player);
+
+int Board_getStaticExchange(Board* board, int fromX, int fromY, int toX, int toY);
+
+int Board_getExactStaticExchange(Board* board, int fromX, int fromY, int toX, int toY);
+
 void Board_print     (Board* board);
 
 void Board_free      (Board* board);
@@ -0,0 +1,584 @@
+/*
+ * Move generation and check detection for a single player.
+ *
+ * This file is included by Board.c once for each player, with PLAYER defined as
+ * WHITE or BLACK and COLORED(name) defined to append the player's color to a name.
+ * Every decision that depends on the player (forward direction, furthest row,
+ * promotion pieces, enemy pieces) is therefore a constant in each copy.
+ */
+
+#define ENEMY         (!PLAYER)
+#define FORWARD       ((PLAYER == WHITE)? 1: -1)
+#define HOME_ROW      ((PLAYER == WHITE)? 1: Board_SIZE)
+#define FURTHEST_ROW  ((PLAYER == WHITE)? Board_SIZE: 1)
+#define OWN(type)     Board_PIECE(type, PLAYER)
+#define ENEMYS(type)  Board_PIECE(type, ENEMY)
+
+/*
+ * Checks if the player's king can be captured by an enemy pawn.
+ * @params: (board) - the board to be checked
+ *
+ * @return: 1 if the player's king can be captured by an enemy pawn, 0 otherwise
+ */
+static int COLORED(canBeCapturedByAPawn)(Board* board){
+	uint64_t attackers = pawnAttacks[PLAYER][board->kingSquare[PLAYER]];
+	while (attackers){
+		if (getCode(board, popSquare(&attackers)) == ENEMYS(Board_PAWN)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Checks if the player's king can be captured by an enemy knight.
+ * @params: (board) - the board to be checked
+ *
+ * @return: 1 if the player's king can be captured by an enemy knight, 0 otherwise
+ */
+static int COLORED(canBeCapturedByAKnight)(Board* board){
+	uint64_t attackers = knightAttacks[board->kingSquare[PLAYER]];
+	while (attackers){
+		if (getCode(board, popSquare(&attackers)) == ENEMYS(Board_KNIGHT)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Checks if the player's king can be captured by an enemy bishop, rook or queen.
+ * @params: (board) - the board to be checked
+ *
+ * @return: 1 if the player's king can be captured by an enemy bishop, rook or queen, 0 otherwise
+ */
+static int COLORED(canBeCapturedByABishopRookOrQueen)(Board* board){
+	for (int sideward = -1; sideward <= 1; sideward++){
+		for (int forward = -1; forward <= 1; forward++){
+			for (int dist = 1; dist <= 7; dist++){
+				int x = Board_FILE(board->kingSquare[PLAYER])+dist*sideward;
+				int y = Board_RANK(board->kingSquare[PLAYER])+dist*forward;
+
+				if (!Board_isInRange(x, y)){
+					break;
+				}
+				char piece = Board_getPiece(board, x, y);
+				if (piece == Board_EMPTY){
+					continue;
+				}
+				if (piece == ENEMYS(Board_QUEEN)){
+					return 1;
+				}
+				if (piece == ENEMYS(Board_ROOK)){
+					if (forward == 0 || sideward == 0){
+						return 1;
+					}
+					break;
+				}
+				if (piece == ENEMYS(Board_BISHOP)){
+					if (sideward != 0 && forward != 0){
+						return 1;
+					}
+					break;
+				}
+				break;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Checks if the board is now in "check" for the player,
+ * by checking whether their king is at risk of being captured.
+ * @params: (board) - the board to be checked
+ *
+ * @return: 1 if the player's king can be captured by an enemy piece, 0 otherwise
+ */
+static int COLORED(isInCheck)(Board* board){
+	return COLORED(canBeCapturedByAPawn)(board)
+		|| COLORED(canBeCapturedByAKnight)(board)
+		|| COLORED(canBeCapturedByABishopRookOrQueen)(board)
+		|| canBeCapturedByAKing(board);
+}
+
+/*
+ * Adds a pawn move from (fromX, fromY) to (toX, toY) to (possibleMoves) if it is legal,
+ * once for each possible promotion if the pawn reaches the furthest row.
+ *
+ * @return: -2 if an allocation error occured, 0 otherwise
+ */
+static int COLORED(addPawnMoveIfLegal)(LinkedList* possibleMoves, Board* board,
+			int fromX, int fromY, int toX, int toY){
+	static const char promotionOptions[4] = {OWN(Board_QUEEN), OWN(Board_BISHOP), OWN(Board_KNIGHT), OWN(Board_ROOK)};
+	int numOfOptions = (toY == FURTHEST_ROW)? 4: 1;
+	for (int i = 0; i < numOfOptions; i++){  //generate all possible promotions
+		char promotion = (toY == FURTHEST_ROW)? promotionOptions[i]: 0;
+		PossibleMove* move = PossibleMove_new(fromX, fromY, toX, toY, promotion, board);
+		if (!move){
+			return -2;
+		}
+		if (!COLORED(isInCheck)(move->board)){
+			if(LinkedList_add(possibleMoves, move)){
+				return -2;
+			}
+		}
+		else{
+			PossibleMove_free(move);
+		}
+	}
+	return 0;
+}
+
+/*
+ * Gets all possible moves for a given pawn piece on a given board.
+ *
+ * @params: (board) - a pointer to the relevant board
+ *          (fromX, fromY) - location of the relevant pawn on (board)
+ *
+ * @return: A list of all possible moves for the relevant pawn.
+ */
+static LinkedList* COLORED(getPawnMoves)(Board* board, int fromX, int fromY, int kinds, uint64_t targets){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+
+	// promotions are generated along with the captures
+	int toY = fromY+FORWARD;
+	int pushKind = (toY == FURTHEST_ROW)? Board_CAPTURES: Board_QUIETS;
+	if (Board_isInRange(fromX, toY) && Board_isEmpty(board, fromX, toY)
+			&& (kinds & pushKind) && (targets & BIT(Board_SQUARE(fromX, toY)))){
+		if (COLORED(addPawnMoveIfLegal)(possibleMoves, board, fromX, fromY, fromX, toY) == -2){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+	}
+
+	uint64_t captureSquares = (kinds & Board_CAPTURES)? pawnAttacks[PLAYER][Board_SQUARE(fromX, fromY)] & targets: 0;
+	while (captureSquares){
+		int square = popSquare(&captureSquares);
+		char captured = getCode(board, square);
+		// the enemy king is never actually captured
+		if (Board_COLOR_OF(captured) != ENEMY || captured == ENEMYS(Board_KING)){
+			continue;
+		}
+		if (COLORED(addPawnMoveIfLegal)(possibleMoves, board, fromX, fromY, Board_FILE(square), Board_RANK(square)) == -2){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+	}
+	return possibleMoves;
+}
+
+/*
+ * Adds a single possible move from (fromX, fromY) to (fromX+sideward, fromY+forward)
+ * to (possibleMoves) if  this move is legal, of one of the wanted (kinds) and lands on one of the (targets).
+ *
+ * @return: -1 if the given position is occupied or out of range,
+ *		    -2 if an allocation error occured
+ *           0 otherwise
+ */
+static int COLORED(addMoveIfLegal)(LinkedList* possibleMoves, Board* board,
+			int fromX, int fromY, int sideward, int forward, int kinds, uint64_t targets){
+	int toX = fromX + sideward;
+	int toY = fromY + forward;
+	if (!Board_isInRange(toX, toY)){
+		return -1;
+	}
+	char captured = Board_getPiece(board, toX, toY);
+	if (Board_COLOR_OF(captured) == PLAYER){
+		return -1;
+	}
+	// the enemy king is never actually captured
+	if (captured == ENEMYS(Board_KING)){
+		return -1;
+	}
+	int kind = (captured != Board_EMPTY)? Board_CAPTURES: Board_QUIETS;
+	if ((kinds & kind) && (targets & BIT(Board_SQUARE(toX, toY)))){
+		PossibleMove* move = PossibleMove_new(fromX, fromY, toX, toY, 0, board);
+		if (!move){
+			return -2;
+		}
+		if (!COLORED(isInCheck)(move->board)){
+			if(LinkedList_add(possibleMoves, move)){
+				return -2;
+			}
+		}
+		else {
+			PossibleMove_free(move);
+		}
+	}
+
+	if (captured != Board_EMPTY){
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Gets all possible moves for a given bishop piece on a given board.
+ *
+ * @return: A list of all possible moves for a bishop located at (fromX, fromY) on (board)
+ */
+static LinkedList* COLORED(getBishopMoves)(Board* board, int fromX, int fromY, int kinds, uint64_t targets){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	for (int sideward = -1; sideward <= 1; sideward += 2){
+		for (int forward = -1; forward <= 1; forward += 2){
+			for (int dist = 1; dist < Board_SIZE; dist++){
+				int cantMoveFurther = COLORED(addMoveIfLegal)(possibleMoves, board, fromX, fromY, dist*sideward, dist*forward, kinds, targets);
+				if(cantMoveFurther == -2){
+					return NULL;
+				}
+				if (cantMoveFurther == -1){
+					break;
+				}
+			}
+		}
+	}
+	return possibleMoves;
+}
+
+/*
+ * Checks if a clear and safe horizontal path exists on (board) between (fromX, y) and (toX, y).
+ * That is, a path that is not occupied by any piece, and if the king would move from (fromX, y) to (toX, y),
+ * at no point will it be under attack.
+ * @params: (board) - the board to be checked
+ *		    (fromX), (toX), (y) - the relevant coordinates on the board
+ *
+ * @return: 1 if such a path exists, 0 otherwise, -1 if an allocation error occurred
+ */
+static int COLORED(clearAndSafeHorizontalPathExistsForKing)(Board* board, int fromX, int toX, int y){
+	int exitcode = 1;
+	int adjustment = (toX < fromX)? -1 : 1;
+
+	for (int i = 1; i <= 2; i++){
+		if(!Board_isEmpty(board, fromX+i*adjustment, y)){
+			exitcode = 0;
+			break;
+		}
+		PossibleMove* step = PossibleMove_new(fromX+(i-1)*adjustment, y, fromX+adjustment*i, y, 0, board);
+		if(!step){
+			return -1;
+		}
+		if(COLORED(isInCheck)(step->board)){
+			exitcode = 0;
+			PossibleMove_free(step);
+			break;
+		}
+		PossibleMove_free(step);
+	}
+	return exitcode;
+}
+
+/*
+ * Gets the castling move with the rook located at (x, y), if it is legal.
+ *
+ * @return: A list containing the castling move, an empty list if it is illegal,
+ *          NULL if an allocation error occurred
+ */
+static LinkedList* COLORED(getCastlingMoves)(Board* board, int x, int y){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	int side = (x == 1)? QUEEN_SIDE : KING_SIDE;
+	if ((y != HOME_ROW)
+		|| (Board_getPiece(board, x, y) != OWN(Board_ROOK))
+		|| (board->kingSquare[PLAYER] != Board_SQUARE(5, HOME_ROW))
+		|| (Board_hasRookEverMoved(board, PLAYER, side))
+		|| (COLORED(isInCheck)(board))){
+		return possibleMoves; //empty list
+	}
+	int kingDestX = (x == 1)? 3 : 7;
+	int clearPathExistsForKing = COLORED(clearAndSafeHorizontalPathExistsForKing)(board, 5, kingDestX, y);
+	if (clearPathExistsForKing == -1){
+		PossibleMoveList_free(possibleMoves);
+		return NULL;
+	}
+
+	if (Board_clearHorizontalPathExists(board, 5, x, y)
+		&& clearPathExistsForKing){
+		PossibleMove* newCastlingMove = PossibleMove_new(x, y, 0, 0, 0, board);
+		if(!newCastlingMove){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		if(LinkedList_add(possibleMoves, newCastlingMove)){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+	}
+	return possibleMoves;
+}
+
+/*
+ * Gets all possible moves for a given rook piece on a given board.
+ *
+ * @return: A list of all possible moves for a rook located at (fromX, fromY) on (board)
+ */
+static LinkedList* COLORED(getRookMoves)(Board* board, int fromX, int fromY, int calledForQueen, int alreadyGotCastlingMoves,
+			int kinds, uint64_t targets){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	for (int sideward = -1; sideward <= 1; sideward += 2){
+		for (int dist = 1; dist < Board_SIZE; dist++){
+			int cantMoveFurther = COLORED(addMoveIfLegal)(possibleMoves, board, fromX, fromY, sideward*dist, 0, kinds, targets);
+			if (cantMoveFurther == -2){
+				return NULL;
+			}
+			if (cantMoveFurther == -1){
+				break;
+			}
+		}
+	}
+	for (int forward = -1; forward <= 1; forward += 2){
+		for (int dist = 1; dist < Board_SIZE; dist++){
+			int cantMoveFurther = COLORED(addMoveIfLegal)(possibleMoves, board, fromX, fromY, 0, forward*dist, kinds, targets);
+			if (cantMoveFurther == -2){
+				return NULL;
+			}
+			if (cantMoveFurther == -1){
+				break;
+			}
+		}
+	}
+	if (!calledForQueen && !alreadyGotCastlingMoves && (kinds & Board_QUIETS)){
+		LinkedList* castlingMoves = COLORED(getCastlingMoves)(board, fromX, fromY);
+		if (!castlingMoves){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		LinkedList_concatenateAndFree(possibleMoves, castlingMoves);
+	}
+	return possibleMoves;
+}
+
+/*
+ * Gets all possible moves for a given queen piece on a given board.
+ *
+ * @return: A list of all possible moves for a queen located at (fromX, fromY) on (board)
+ */
+static LinkedList* COLORED(getQueenMoves)(Board* board, int fromX, int fromY, int alreadyGotCastlingMoves,
+			int kinds, uint64_t targets){
+	LinkedList* possibleMoves1;
+	LinkedList* possibleMoves2;
+	possibleMoves1 = COLORED(getBishopMoves)(board, fromX, fromY, kinds, targets);
+	if (!possibleMoves1){
+		return NULL;
+	}
+	possibleMoves2 = COLORED(getRookMoves)  (board, fromX, fromY, 1, alreadyGotCastlingMoves, kinds, targets);
+	if (!possibleMoves2){
+		PossibleMoveList_free(possibleMoves1);
+		return NULL;
+	}
+
+	LinkedList_concatenateAndFree(possibleMoves1, possibleMoves2);
+	return possibleMoves1;
+}
+
+/*
+ * Gets all possible moves for a given knight piece on a given board.
+ *
+ * @return: A list of all possible moves for a knight located at (fromX, fromY) on (board)
+ */
+static LinkedList* COLORED(getKnightMoves)(Board* board, int fromX, int fromY, int kinds, uint64_t targets){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	uint64_t destinations = knightAttacks[Board_SQUARE(fromX, fromY)] & targets & ~board->occupied[PLAYER];
+	while (destinations){
+		int square = popSquare(&destinations);
+		int error = COLORED(addMoveIfLegal)(possibleMoves, board, fromX, fromY, Board_FILE(square)-fromX, Board_RANK(square)-fromY, kinds, targets);
+		if (error == -2){
+			return NULL;
+		}
+	}
+	return possibleMoves;
+}
+
+/*
+ * Gets all possible moves for a given king piece on a given board.
+ *
+ * @return: A list of all possible moves for a king located at (fromX, fromY) on (board)
+ */
+static LinkedList* COLORED(getKingMoves)(Board* board, int fromX, int fromY, int alreadyGotCastlingMoves,
+			int kinds, uint64_t targets){
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	uint64_t destinations = kingAttacks[Board_SQUARE(fromX, fromY)] & targets & ~board->occupied[PLAYER];
+	while (destinations){
+		int square = popSquare(&destinations);
+		int error = COLORED(addMoveIfLegal)(possibleMoves, board, fromX, fromY, Board_FILE(square)-fromX, Board_RANK(square)-fromY, kinds, targets);
+		if (error == -2){
+			return NULL;
+		}
+	}
+
+	if (!alreadyGotCastlingMoves && (kinds & Board_QUIETS)){
+		LinkedList* castlingMoves1 = COLORED(getCastlingMoves)(board, 1, fromY);
+		if (!castlingMoves1){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		LinkedList_concatenateAndFree(possibleMoves, castlingMoves1);
+
+		LinkedList* castlingMoves2 = COLORED(getCastlingMoves)(board, 8, fromY);
+		if (!castlingMoves2){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		LinkedList_concatenateAndFree(possibleMoves, castlingMoves2);
+	}
+	return possibleMoves;
+}
+
+/*
+ * Gets the possible moves of one of the player's pieces, 
+ * of the wanted (kinds) and landing on one of the (targets).
+ *
+ * @return: A list of the possible moves for a piece located at (x, y) on (board)
+ */
+static LinkedList* COLORED(getPossibleMovesOfPiece)(Board* board, int x, int y, int alreadyGotCastlingMoves, 
+			int kinds, uint64_t targets){
+	switch (Board_TYPE_OF(Board_getPiece(board, x, y))){
+		case Board_PAWN:   return COLORED(getPawnMoves)  (board, x, y, kinds, targets);
+		case Board_BISHOP: return COLORED(getBishopMoves)(board, x, y, kinds, targets);
+		case Board_ROOK:   return COLORED(getRookMoves)  (board, x, y, 0, alreadyGotCastlingMoves, kinds, targets);
+		case Board_QUEEN:  return COLORED(getQueenMoves) (board, x, y, alreadyGotCastlingMoves, kinds, targets);
+		case Board_KNIGHT: return COLORED(getKnightMoves)(board, x, y, kinds, targets);
+		case Board_KING:   return COLORED(getKingMoves)  (board, x, y, alreadyGotCastlingMoves, kinds, targets);
+	}
+	return PossibleMoveList_new();
+}
+
+/*
+ * Gets the moves currently possible for the player, of the wanted (kinds).
+ *
+ * @return: a list of the possible moves, or NULL if any allocation errors occurred
+ */
+static LinkedList* COLORED(getPossibleMoves)(Board* board, int kinds){
+	int gotCastlingMoves = 0;
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	uint64_t pieces = board->occupied[PLAYER];
+	while (pieces){
+		int square = popSquare(&pieces);
+		char piece = getCode(board, square);
+		if (piece == OWN(Board_KING) || piece == OWN(Board_ROOK)){
+			gotCastlingMoves = 1;
+		}
+		LinkedList* pieceMoves = COLORED(getPossibleMovesOfPiece)(board, Board_FILE(square), Board_RANK(square), gotCastlingMoves,
+				kinds, ~(uint64_t)0);
+		if (!pieceMoves){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		LinkedList_concatenateAndFree(possibleMoves, pieceMoves);
+	}
+	return possibleMoves;
+}
+
+/*
+ * Finds the enemy pieces that give check to the player's king.
+ *
+ * @params: (numOfCheckers) - set to the number of pieces giving check
+ * @return: the squares of the checking pieces, together with the squares between 
+ *          a checking bishop, rook or queen and the king
+ */
+static uint64_t COLORED(getCheckBlockingSquares)(Board* board, int* numOfCheckers){
+	int kingSquare = board->kingSquare[PLAYER];
+	uint64_t blockingSquares = 0;
+	*numOfCheckers = 0;
+
+	uint64_t attackers = pawnAttacks[PLAYER][kingSquare];
+	while (attackers){
+		int square = popSquare(&attackers);
+		if (getCode(board, square) == ENEMYS(Board_PAWN)){
+			blockingSquares |= BIT(square);
+			(*numOfCheckers)++;
+		}
+	}
+	attackers = knightAttacks[kingSquare];
+	while (attackers){
+		int square = popSquare(&attackers);
+		if (getCode(board, square) == ENEMYS(Board_KNIGHT)){
+			blockingSquares |= BIT(square);
+			(*numOfCheckers)++;
+		}
+	}
+	for (int sideward = -1; sideward <= 1; sideward++){
+		for (int forward = -1; forward <= 1; forward++){
+			uint64_t ray = 0;
+			for (int dist = 1; dist < Board_SIZE; dist++){
+				int x = Board_FILE(kingSquare)+dist*sideward;
+				int y = Board_RANK(kingSquare)+dist*forward;
+				if ((sideward == 0 && forward == 0) || !Board_isInRange(x, y)){
+					break;
+				}
+				ray |= BIT(Board_SQUARE(x, y));
+				char piece = Board_getPiece(board, x, y);
+				if (piece == Board_EMPTY){
+					continue;
+				}
+				int straight = (sideward == 0 || forward == 0);
+				if (piece == ENEMYS(Board_QUEEN) 
+						|| (piece == ENEMYS(Board_ROOK) && straight) 
+						|| (piece == ENEMYS(Board_BISHOP) && !straight)){
+					blockingSquares |= ray;
+					(*numOfCheckers)++;
+				}
+				break;
+			}
+		}
+	}
+	return blockingSquares;
+}
+
+/*
+ * Gets the moves possible for the player while their king is in check:
+ * king moves, and when only one piece gives check, capturing it or blocking its path.
+ *
+ * @return: a list of the possible moves, or NULL if any allocation errors occurred
+ */
+static LinkedList* COLORED(getEvasions)(Board* board){
+	int numOfCheckers;
+	uint64_t blockingSquares = COLORED(getCheckBlockingSquares)(board, &numOfCheckers);
+	LinkedList* possibleMoves = PossibleMoveList_new();
+	if (!possibleMoves){
+		return NULL;
+	}
+	uint64_t pieces = board->occupied[PLAYER];
+	while (pieces){
+		int square = popSquare(&pieces);
+		int isKing = (getCode(board, square) == OWN(Board_KING));
+		if (!isKing && numOfCheckers > 1){
+			continue;
+		}
+		LinkedList* pieceMoves = COLORED(getPossibleMovesOfPiece)(board, Board_FILE(square), Board_RANK(square), 1,
+				Board_ALL_KINDS, isKing? ~(uint64_t)0: blockingSquares);
+		if (!pieceMoves){
+			PossibleMoveList_free(possibleMoves);
+			return NULL;
+		}
+		LinkedList_concatenateAndFree(possibleMoves, pieceMoves);
+	}
+	return possibleMoves;
+}
+
+#undef ENEMY
+#undef FORWARD
+#undef HOME_ROW
+#undef FURTHEST_ROW
+#undef OWN
+#undef ENEMYS
@@ -0,0 +1,483 @@
+#define _POSIX_C_SOURCE 200112L /* mmap, fstat */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Book.h"
+#include "LinkedList.h"
+#include "PossibleMoveList.h"
+#include "Iterator.h"
+
+#define CASTLE     0xFF /* the destination of a castling move */
+#define MAX_PLIES  24   /* how deep into each game the builder records moves */
+#define MAX_TOKEN  32
+
+/*
+ * A move of the book, from the position with the given key.
+ * Squares are indexed as in Board_SQUARE, and (to) is CASTLE for castling with the rook on (from).
+ * (weight) is the number of games the move was played in.
+ */
+typedef struct BookEntry{
+	uint64_t key;
+	unsigned char from, to;
+	char promotion;
+	unsigned char unused;
+	uint32_t weight;
+} BookEntry;
+
+typedef char BookEntry_isSixteenBytes[(sizeof(BookEntry) == 16)? 1: -1];
+
+static const BookEntry* entries = NULL;
+static long numOfEntries = 0;
+
+/*
+ * Maps the book at (path) into memory.
+ *
+ * @return: -1 if the book could not be opened, 0 otherwise
+ */
+int Book_open(const char* path){
+	int fd = open(path, O_RDONLY);
+	if (fd == -1){
+		return -1;
+	}
+	struct stat info;
+	if (fstat(fd, &info) == -1 || info.st_size == 0 || info.st_size % sizeof(BookEntry) != 0){
+		close(fd);
+		return -1;
+	}
+	void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED){
+		return -1;
+	}
+	entries = (const BookEntry*)data;
+	numOfEntries = info.st_size / sizeof(BookEntry);
+	return 0;
+}
+
+static int isEntryMove(const BookEntry* entry, PossibleMove* move){
+	int to = (move->toX == 0)? CASTLE: Board_SQUARE(move->toX, move->toY);
+	return entry->from == Board_SQUARE(move->fromX, move->fromY) && entry->to == to
+		&& entry->promotion == move->promotion;
+}
+
+/*
+ * Picks one of the book moves of (board) at random, by their weights.
+ *
+ * @params: (move) - set to the move, NULL if the book has no legal move for (board)
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+int Book_getMove(Board* board, int player, PossibleMove** move){
+	*move = NULL;
+	long first = 0;
+	long last = numOfEntries;
+	while (first < last){ // the first entry of the position, if there is one
+		long middle = first + (last - first)/2;
+		if (entries[middle].key < board->key){
+			first = middle + 1;
+		}
+		else{
+			last = middle;
+		}
+	}
+	uint32_t totalWeight = 0;
+	for (long i = first; i < numOfEntries && entries[i].key == board->key; i++){
+		totalWeight += entries[i].weight;
+	}
+	if (totalWeight == 0){
+		return 0;
+	}
+	uint32_t choice = rand() % totalWeight;
+	const BookEntry* entry = &entries[first];
+	while (choice >= entry->weight){
+		choice -= entry->weight;
+		entry++;
+	}
+
+	// the move is checked in case another position has the same key
+	int fromX = Board_FILE(entry->from);
+	int fromY = Board_RANK(entry->from);
+	if (Board_getColor(board, fromX, fromY) != player){
+		return 0;
+	}
+	LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(board, fromX, fromY, 0);
+	if (!pieceMoves){
+		return -1;
+	}
+	Iterator iterator;
+	Iterator_init(&iterator, pieceMoves);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* candidate = (PossibleMove*)Iterator_next(&iterator);
+		if (isEntryMove(entry, candidate)){
+			*move = candidate;
+			break;
+		}
+	}
+	LinkedList_freeAllButOne(pieceMoves, *move);
+	return 0;
+}
+
+/*
+ * A move in standard algebraic notation, as written in PGN files.
+ * (fromX, fromY) are 0 when they are not given, (castlingSide) is -1 for moves other than castling.
+ */
+typedef struct SanMove{
+	int type;
+	int castlingSide;
+	int fromX, fromY;
+	int toX, toY;
+	int promotion;
+} SanMove;
+
+/*
+ * The state of the builder while it reads the games.
+ * A game stops being recorded after MAX_PLIES moves, or at a move that cannot be played here.
+ */
+typedef struct BookBuilder{
+	Board position;
+	int player;
+	int plies;
+	int recording;
+	long numOfGames;
+	BookEntry* entries;
+	long numOfEntries;
+	long capacity;
+} BookBuilder;
+
+static int charToType(char ch){
+	switch (ch){
+		case 'N': return Board_KNIGHT;
+		case 'B': return Board_BISHOP;
+		case 'R': return Board_ROOK;
+		case 'Q': return Board_QUEEN;
+		case 'K': return Board_KING;
+	}
+	return 0;
+}
+
+/*
+ * @return: -1 if (token) is not a move, 0 otherwise
+ */
+static int parseSan(const char* token, SanMove* san){
+	char text[MAX_TOKEN];
+	int length = 0;
+	for (int i = 0; token[i] && length < MAX_TOKEN-1; i++){
+		if (!strchr("+#!?", token[i])){
+			text[length++] = token[i];
+		}
+	}
+	text[length] = '\0';
+	san->type = Board_PAWN;
+	san->castlingSide = -1;
+	san->toX = 0;
+	san->toY = 0;
+	san->fromX = 0;
+	san->fromY = 0;
+	san->promotion = 0;
+	if (strcmp(text, "O-O") == 0 || strcmp(text, "0-0") == 0){
+		san->castlingSide = KING_SIDE;
+		return 0;
+	}
+	if (strcmp(text, "O-O-O") == 0 || strcmp(text, "0-0-0") == 0){
+		san->castlingSide = QUEEN_SIDE;
+		return 0;
+	}
+	int start = 0;
+	if (charToType(text[0])){
+		san->type = charToType(text[0]);
+		start = 1;
+	}
+	char* equals = strchr(text, '=');
+	if (equals){
+		san->promotion = charToType(equals[1]);
+		length = equals - text;
+	}
+	else if (san->type == Board_PAWN && length > 0 && charToType(text[length-1])){
+		san->promotion = charToType(text[length-1]);
+		length--;
+	}
+	if (length - start < 2 || text[length-2] < 'a' || text[length-2] > 'h'
+			|| text[length-1] < '1' || text[length-1] > '8'){
+		return -1;
+	}
+	san->toX = text[length-2] - 'a' + 1;
+	san->toY = text[length-1] - '0';
+	for (int i = start; i < length-2; i++){
+		if (text[i] >= 'a' && text[i] <= 'h'){
+			san->fromX = text[i] - 'a' + 1;
+		}
+		else if (text[i] >= '1' && text[i] <= '8'){
+			san->fromY = text[i] - '0';
+		}
+		else if (text[i] != 'x'){
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Finds the possible move of (player) described by (san).
+ *
+ * @params: (move) - set to the move, NULL if there is no such move or more than one
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int findSanMove(Board* board, int player, SanMove* san, PossibleMove** move){
+	*move = NULL;
+	LinkedList* possibleMoves;
+	if (san->castlingSide != -1){
+		int rookX = (san->castlingSide == KING_SIDE)? Board_SIZE: 1;
+		int rookY = (player == WHITE)? 1: Board_SIZE;
+		if (Board_getColor(board, rookX, rookY) != player){
+			return 0;
+		}
+		possibleMoves = Board_getPossibleMovesOfPiece(board, rookX, rookY, 0);
+	}
+	else{
+		possibleMoves = Board_getPossibleMoves(board, player);
+	}
+	if (!possibleMoves){
+		return -1;
+	}
+	int numOfMatches = 0;
+	Iterator iterator;
+	Iterator_init(&iterator, possibleMoves);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* candidate = (PossibleMove*)Iterator_next(&iterator);
+		int matches;
+		if (san->castlingSide != -1){
+			matches = candidate->toX == 0;
+		}
+		else{
+			matches = candidate->toX == san->toX && candidate->toY == san->toY
+				&& Board_TYPE_OF(Board_getPiece(board, candidate->fromX, candidate->fromY)) == san->type
+				&& (!san->fromX || candidate->fromX == san->fromX)
+				&& (!san->fromY || candidate->fromY == san->fromY)
+				&& Board_TYPE_OF(candidate->promotion) == san->promotion;
+		}
+		if (matches){
+			*move = candidate;
+			numOfMatches++;
+		}
+	}
+	if (numOfMatches != 1){
+		*move = NULL;
+	}
+	LinkedList_freeAllButOne(possibleMoves, *move);
+	return 0;
+}
+
+static void startGame(BookBuilder* builder){
+	Board_init(&builder->position);
+	builder->player = WHITE;
+	builder->plies = 0;
+	builder->recording = 1;
+}
+
+/*
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int addEntry(BookBuilder* builder, PossibleMove* move){
+	if (builder->numOfEntries == builder->capacity){
+		long capacity = (builder->capacity)? 2*builder->capacity: 1024;
+		BookEntry* grown = (BookEntry*)realloc(builder->entries, capacity*sizeof(BookEntry));
+		if (!grown){
+			return -1;
+		}
+		builder->entries = grown;
+		builder->capacity = capacity;
+	}
+	BookEntry* entry = &builder->entries[builder->numOfEntries++];
+	entry->key = builder->position.key;
+	entry->from = Board_SQUARE(move->fromX, move->fromY);
+	entry->to = (move->toX == 0)? CASTLE: Board_SQUARE(move->toX, move->toY);
+	entry->promotion = move->promotion;
+	entry->unused = 0;
+	entry->weight = 1;
+	return 0;
+}
+
+/*
+ * Plays a single word of the movetext of a game: a move number, a move or a result.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int playToken(BookBuilder* builder, char* token){
+	if (strcmp(token, "1-0") == 0 || strcmp(token, "0-1") == 0
+			|| strcmp(token, "1/2-1/2") == 0 || strcmp(token, "*") == 0){
+		builder->numOfGames++;
+		startGame(builder);
+		return 0;
+	}
+	char* afterNumber = token;
+	while (isdigit(*afterNumber)){
+		afterNumber++;
+	}
+	if (afterNumber != token && *afterNumber == '.'){ // a move number, maybe followed by the move
+		token = afterNumber;
+		while (*token == '.'){
+			token++;
+		}
+	}
+	if (!*token || !builder->recording){
+		return 0;
+	}
+	SanMove san;
+	if (builder->plies == MAX_PLIES || parseSan(token, &san)){
+		builder->recording = 0;
+		return 0;
+	}
+	PossibleMove* move;
+	if (findSanMove(&builder->position, builder->player, &san, &move)){
+		return -1;
+	}
+	if (!move){ // not a legal move in this game, for example a pawn moving two squares
+		builder->recording = 0;
+		return 0;
+	}
+	int exitcode = addEntry(builder, move);
+	Board_copy(&builder->position, move->board);
+	builder->player = !builder->player;
+	builder->plies++;
+	PossibleMove_free(move);
+	return exitcode;
+}
+
+/*
+ * Skips the characters of (file) up to and including (last).
+ */
+static void skipUntil(FILE* file, int last){
+	int ch;
+	while ((ch = fgetc(file)) != EOF && ch != last);
+}
+
+/*
+ * Reads the games of a PGN file, skipping tags, comments, variations and annotations.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int readGames(BookBuilder* builder, FILE* file){
+	char token[MAX_TOKEN];
+	int length = 0;
+	int ch;
+	do{
+		ch = fgetc(file);
+		if (ch != EOF && !isspace(ch) && !strchr("[{;($)", ch)){
+			if (length < MAX_TOKEN-1){
+				token[length++] = ch;
+			}
+			continue;
+		}
+		if (length > 0){
+			token[length] = '\0';
+			length = 0;
+			if (playToken(builder, token)){
+				return -1;
+			}
+		}
+		switch (ch){
+			case '[':
+				if (builder->plies > 0 || !builder->recording){ // a game without a result
+					startGame(builder);
+				}
+				skipUntil(file, ']');
+				break;
+			case '{': skipUntil(file, '}'); break;
+			case ';': skipUntil(file, '\n'); break;
+			case '(':
+				for (int depth = 1; depth > 0 && (ch = fgetc(file)) != EOF; ){
+					depth += (ch == '(') - (ch == ')');
+				}
+				break;
+			case '$':
+				while (isdigit(ch = fgetc(file)));
+				ungetc(ch, file);
+				break;
+		}
+	} while (ch != EOF);
+	return 0;
+}
+
+static int compareEntries(const void* a, const void* b){
+	const BookEntry* first = (const BookEntry*)a;
+	const BookEntry* second = (const BookEntry*)b;
+	if (first->key != second->key){
+		return (first->key < second->key)? -1: 1;
+	}
+	if (first->from != second->from){
+		return first->from - second->from;
+	}
+	if (first->to != second->to){
+		return first->to - second->to;
+	}
+	return first->promotion - second->promotion;
+}
+
+/*
+ * Sorts the entries, merging the ones of the same move into a single weighted entry.
+ */
+static void mergeEntries(BookBuilder* builder){
+	qsort(builder->entries, builder->numOfEntries, sizeof(BookEntry), &compareEntries);
+	long merged = 0;
+	for (long i = 0; i < builder->numOfEntries; i++){
+		if (merged > 0 && compareEntries(&builder->entries[merged-1], &builder->entries[i]) == 0){
+			builder->entries[merged-1].weight += builder->entries[i].weight;
+		}
+		else{
+			builder->entries[merged++] = builder->entries[i];
+		}
+	}
+	builder->numOfEntries = merged;
+}
+
+/*
+ * Builds a book out of the games of the given PGN files, and saves it at (bookPath).
+ *
+ * @return: 1 if an allocation error occurred, 
+ *          -9 if one of the files could not be opened or the book could not be written, 0 otherwise
+ */
+int Book_build(const char* bookPath, char* pgnPaths[], int numOfPaths){
+	BookBuilder builder;
+	builder.numOfGames = 0;
+	builder.entries = NULL;
+	builder.numOfEntries = 0;
+	builder.capacity = 0;
+	int exitcode = 0;
+	for (int i = 0; i < numOfPaths && exitcode == 0; i++){
+		FILE* file = fopen(pgnPaths[i], "r");
+		if (!file){
+			exitcode = -9;
+			break;
+		}
+		startGame(&builder);
+		if (readGames(&builder, file)){
+			exitcode = 1;
+		}
+		fclose(file);
+	}
+	if (exitcode == 0){
+		mergeEntries(&builder);
+		FILE* book = fopen(bookPath, "wb");
+		if (!book){
+			exitcode = -9;
+		}
+		else{
+			if (fwrite(builder.entries, sizeof(BookEntry), builder.numOfEntries, book) != (size_t)builder.numOfEntries){
+				exitcode = -9;
+			}
+			fclose(book);
+		}
+	}
+	if (exitcode == 0){
+		printf("%ld moves from %ld games written to %s\n", builder.numOfEntries, builder.numOfGames, bookPath);
+	}
+	free(builder.entries);
+	return exitcode;
+}
@@ -0,0 +1,21 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "Board.h"
+#include "PossibleMove.h"
+
+/*
+ * An opening book: a file of (position key, move, weight) records sorted by key,
+ * mapped into memory and searched by binary search.
+ * Books are built from PGN files with "chessprog build_book <book> <pgn files...>".
+ * Since the records hold position keys, a book only fits the key scheme it was built with.
+ */
+#define Book_FILE "book.bin"
+
+int Book_open(const char* path);
+
+int Book_getMove(Board* board, int player, PossibleMove** move);
+
+int Book_build(const char* bookPath, char* pgnPaths[], int numOfPaths);
+
+#endif
@@ -5,6 +5,17 @@
  */
   
 int initialize(){
+	Board_initAttackTables();
+	Board_initZobristKeys();
+	Board_initMaterial();
+	if (Bitbase_init()){
+		return 1;
+	}
+	Book_open(Book_FILE); // without a book, every move is searched
+	Nnue_load(Nnue_FILE); // without weights, the network cannot be switched on
+	if (EvalCache_setSize(EvalCache_DEFAULT_SIZE)){
+		return 1;
+	}
 	Board_init(&board);
 	if (displayMode == GUI){
 		int initializationError = GUI_init();
@@ -14,6 +25,8 @@ int initialize(){
 	}
 	state = SETTINGS;
 	maxRecursionDepth = 1;	
+	useNeuralNetwork = 0;
+	usePondering = 1;
 	player1 = WHITE;
 	turn = player1;
 	first = WHITE;
@@ -52,75 +65,308 @@ void allocationFailed(){
 }
 
 /*
- * The minimax AI algorithm.
+ * Evaluates a board for the player the search is for, using the neural network if it is switched on,
+ * and otherwise the scoring function of the current difficulty.
+ * Scores are looked up in the evaluation cache first.
+ *
+ * @params: (player) - the player whose turn it is on (board)
+ *          (ply) - the number of moves between the root of the search and (board)
  */
-int alphabeta(PossibleMove* possibleMove, int depth, int player, int alpha, int beta){
-	int (*evaluationFunction)(Board*, int, int) = (maxRecursionDepth == BEST)?
-				&Board_getBetterScore:
-				&Board_getScore;
-	int thisBoardScore = evaluationFunction(possibleMove->board, turn, player);
-	// maximum depth reached or game is over or allocation error occurred in Board_getScore
-	if (depth == 1 || thisBoardScore == 10000 || thisBoardScore == -10000 || thisBoardScore == -10001){
-		return thisBoardScore;
+int evaluate(Board* board, int player, int ply){
+	int function = (useNeuralNetwork)? 2: (maxRecursionDepth == BEST);
+	int whiteScore;
+	if (EvalCache_probe(board, player, function, &whiteScore)){
+		return (searchPlayer == WHITE)? whiteScore: -whiteScore;
 	}
-	
-	Board* board = possibleMove->board;
-	LinkedList* possibleMoves = Board_getPossibleMoves(board, player);
-	if (!possibleMoves){
-		return -10001;
+	int score;
+	if (useNeuralNetwork){
+		score = Nnue_getScore(board, searchPlayer, player, ply);
 	}
-	//terminal node
-	if (LinkedList_length(possibleMoves) == 0){
-		LinkedList_free(possibleMoves);
-		return thisBoardScore;
+	else{
+		score = (maxRecursionDepth == BEST)? Board_getBetterScore(board, searchPlayer, player): Board_getScore(board, searchPlayer, player);
 	}
-	//single child node
-	if (LinkedList_length(possibleMoves) == 1){
-		PossibleMove* onlyMove = PossibleMoveList_first(possibleMoves);
-		int score = evaluationFunction(onlyMove->board, turn, player);
-		LinkedList_free(possibleMoves);
-		return score;
+	if (score != -10001){
+		EvalCache_store(board, player, function, (searchPlayer == WHITE)? score: -score);
+	}
+	return score;
+}
+
+/*
+ * Converts a mate found by the scoring functions (ply) moves away from the root into a score 
+ * that prefers shorter mates: the sooner a player mates, the better the score is for them.
+ */
+int adjustMateScore(int score, int ply){
+	if (score == Board_MATE){
+		return Board_MATE - ply;
+	}
+	if (score == -Board_MATE){
+		return -Board_MATE + ply;
+	}
+	return score;
+}
+
+/*
+ * Converts the result of a bitbase for the player to move, (ply) moves away from the root, 
+ * into a score, the same one the search would give the mate.
+ */
+int getBitbaseScore(int result, int plies, int player, int ply){
+	if (result == Bitbase_DRAW){
+		return 0;
 	}
+	int winner = (result == Bitbase_WIN)? player: !player;
+	int score = Board_MATE - (ply + plies);
+	return (winner == searchPlayer)? score: -score;
+}
 
-	int extremum = (player == turn)? INT_MIN : INT_MAX;
+/*
+ * Searches only captures and promotions from a board at the end of the minimax search,
+ * so that the board is not scored in the middle of an exchange of pieces.
+ * Either player may stop capturing, so (thisBoardScore) is a bound on the result.
+ * Captures that lose material are not searched.
+ *
+ * @params: (thisBoardScore) - the evaluation of (board)
+ *          (ply) - the number of moves between the root of the search and (board)
+ * @return: the score of (board), -10001 if an allocation error occurred
+ */
+int quiescence(Board* board, int player, int alpha, int beta, int thisBoardScore, int ply){
+	if (thisBoardScore == Board_MATE || thisBoardScore == -Board_MATE || thisBoardScore == -10001){
+		return adjustMateScore(thisBoardScore, ply);
+	}
+	if (searchPlayer == player){
+		if (thisBoardScore >= beta){
+			return thisBoardScore;
+		}
+		alpha = (thisBoardScore > alpha)? thisBoardScore: alpha;
+	}
+	else{
+		if (thisBoardScore <= alpha){
+			return thisBoardScore;
+		}
+		beta = (thisBoardScore < beta)? thisBoardScore: beta;
+	}
+	
+	LinkedList* captures = Board_getPossibleMovesOfKinds(board, player, Board_CAPTURES);
+	if (!captures){
+		return -10001;
+	}
+	int extremum = thisBoardScore;
 	Iterator iterator;
-	Iterator_init(&iterator, possibleMoves);
-	while (Iterator_hasNext(&iterator)) {
-		PossibleMove* currentPossibleMove = (PossibleMove*)Iterator_next(&iterator);
-		int score = alphabeta(currentPossibleMove, depth-1, !player, alpha, beta);
+	Iterator_init(&iterator, captures);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* capture = (PossibleMove*)Iterator_next(&iterator);
+		if (!capture->promotion && 
+				Board_getStaticExchange(board, capture->fromX, capture->fromY, capture->toX, capture->toY) < 0){
+			continue;
+		}
+		int score = quiescence(capture->board, !player, alpha, beta, evaluate(capture->board, !player, ply+1), ply+1);
 		if (score == -10001){ //allocation error occured
 			extremum = score;
 			break;
 		}
-		if (	(player != turn && score <  extremum) || 
-				(player == turn && score >  extremum) || 
-				(rand()%2       && score == extremum)
-			){
-			extremum = score;
-		}
-		//game over - no need to evaluate further moves
-		// if (extremum == 10000 || extremum == -10000){
-			// break;
-		// }
-		//alpha-beta pruning
-		if (turn == player){
+		if (searchPlayer == player){
+			extremum = (score > extremum)? score: extremum;
 			alpha = (score > alpha)? score: alpha;
-			if (alpha >= beta){
-				break;
-			}	
 		}
 		else{
+			extremum = (score < extremum)? score: extremum;
 			beta = (score < beta)? score: beta;
-			if (beta <= alpha){
-				break;
-			}
 		}
-
+		if (alpha >= beta){
+			break;
+		}
 	}
-	LinkedList_free(possibleMoves);
+	LinkedList_free(captures);
 	return extremum;
 }
 
+/*
+ * A node of the minimax search: what the search of a board holds across the search of its children.
+ * The recursive search (alphabeta) and the stepped search (stepSearch) both search a node with the functions below,
+ * the first keeping frames on the call stack and the second in an array of its own.
+ */
+typedef struct SearchFrame{
+	PossibleMove* possibleMove;
+	int depth;
+	int ply;
+	int player;
+	int alpha;
+	int beta;
+	MoveGenerator generator;
+	PossibleMove* firstMove;
+	PossibleMove* secondMove;
+	PossibleMove* currentMove;
+	PossibleMove* bestMove;
+	int extremum;
+} SearchFrame;
+
+/*
+ * Starts a node, doing everything the search does before searching the children.
+ *
+ * @return: 1 if the node was scored without searching any children, with the score in (frame->extremum), 
+ *          0 if its children are to be searched
+ */
+int enterSearchFrame(SearchFrame* frame){
+	int ply = frame->ply;
+	int player = frame->player;
+	Board* board = frame->possibleMove->board;
+	int thisBoardScore = evaluate(board, player, ply);
+	frame->extremum = thisBoardScore;
+	// game is over or allocation error occurred in Board_getScore
+	if (thisBoardScore == Board_MATE || thisBoardScore == -Board_MATE || thisBoardScore == -10001){
+		frame->extremum = adjustMateScore(thisBoardScore, ply);
+		return 1;
+	}
+	// endgames with few pieces left are looked up rather than searched
+	int plies;
+	int bitbaseResult = Bitbase_probe(board, player, &plies);
+	if (bitbaseResult != Bitbase_NOT_FOUND){
+		frame->extremum = getBitbaseScore(bitbaseResult, plies, player, ply);
+		return 1;
+	}
+	// maximum depth reached
+	if (frame->depth == 1){
+		frame->extremum = quiescence(board, player, frame->alpha, frame->beta, thisBoardScore, ply);
+		return 1;
+	}
+	// mate-distance pruning: no line from here can do better than mating on the next move
+	if (searchPlayer == player){
+		int bestPossible = Board_MATE - (ply+1);
+		frame->beta = (bestPossible < frame->beta)? bestPossible: frame->beta;
+		if (frame->alpha >= frame->beta){
+			frame->extremum = frame->beta;
+			return 1;
+		}
+	}
+	else{
+		int worstPossible = -Board_MATE + (ply+1);
+		frame->alpha = (worstPossible > frame->alpha)? worstPossible: frame->alpha;
+		if (frame->alpha >= frame->beta){
+			frame->extremum = frame->alpha;
+			return 1;
+		}
+	}
+	
+	if (MoveGenerator_init(&frame->generator, board, player)){
+		frame->extremum = -10001;
+		return 1;
+	}
+	int error;
+	frame->firstMove = MoveGenerator_next(&frame->generator, &error);
+	frame->secondMove = (frame->firstMove)? MoveGenerator_next(&frame->generator, &error): NULL;
+	if (error){
+		MoveGenerator_free(&frame->generator);
+		frame->extremum = -10001;
+		return 1;
+	}
+	//terminal node
+	if (!frame->firstMove){
+		MoveGenerator_free(&frame->generator);
+		return 1;
+	}
+	//single child node
+	if (!frame->secondMove){
+		frame->extremum = adjustMateScore(evaluate(frame->firstMove->board, player, ply+1), ply+1);
+		MoveGenerator_free(&frame->generator);
+		return 1;
+	}
+	frame->extremum = (player == searchPlayer)? INT_MIN : INT_MAX;
+	frame->bestMove = NULL;
+	frame->currentMove = frame->firstMove;
+	return 0;
+}
+
+/*
+ * @return: the next child of the node to search, NULL if the node is done
+ */
+PossibleMove* getNextChildOfSearchFrame(SearchFrame* frame){
+	// right above the leaves, captures that lose material are not worth searching
+	if (frame->depth == 2 && frame->bestMove && frame->generator.stage == MoveGenerator_BAD_CAPTURES){
+		return NULL;
+	}
+	return frame->currentMove;
+}
+
+/*
+ * Takes the (score) of the child last searched, and moves on to the next child.
+ *
+ * @return: 1 if the node is done, 0 otherwise
+ */
+int resumeSearchFrame(SearchFrame* frame, int score){
+	if (score == -10001){ //allocation error occured
+		frame->extremum = score;
+		return 1;
+	}
+	int player = frame->player;
+	if (	(player != searchPlayer && score <  frame->extremum) || 
+			(player == searchPlayer && score >  frame->extremum) || 
+			(rand()%2               && score == frame->extremum)
+		){
+		frame->extremum = score;
+		frame->bestMove = frame->currentMove;
+	}
+	//alpha-beta pruning, which also stops the search once the quickest possible mate is found
+	if (searchPlayer == player){
+		frame->alpha = (score > frame->alpha)? score: frame->alpha;
+		if (frame->alpha >= frame->beta){
+			return 1;
+		}	
+	}
+	else{
+		frame->beta = (score < frame->beta)? score: frame->beta;
+		if (frame->beta <= frame->alpha){
+			return 1;
+		}
+	}
+	int error = 0;
+	frame->currentMove = (frame->currentMove == frame->firstMove)? frame->secondMove: MoveGenerator_next(&frame->generator, &error);
+	if (error){
+		frame->extremum = -10001;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Ends a node whose children were searched.
+ */
+void finishSearchFrame(SearchFrame* frame){
+	if (frame->extremum != -10001 && frame->bestMove){
+		MoveGenerator_storeBestMove(frame->possibleMove->board, frame->bestMove);
+	}
+	MoveGenerator_free(&frame->generator);
+}
+
+/*
+ * The minimax AI algorithm.
+ *
+ * @params: (ply) - the number of moves between the root of the search and the board of (possibleMove)
+ */
+int alphabeta(PossibleMove* possibleMove, int depth, int ply, int player, int alpha, int beta){
+	// the result of a cancelled search is thrown away, so any score will do
+	if (searchCancelled){
+		return 0;
+	}
+	SearchFrame frame;
+	frame.possibleMove = possibleMove;
+	frame.depth = depth;
+	frame.ply = ply;
+	frame.player = player;
+	frame.alpha = alpha;
+	frame.beta = beta;
+	if (enterSearchFrame(&frame)){
+		return frame.extremum;
+	}
+	PossibleMove* child;
+	while ((child = getNextChildOfSearchFrame(&frame))){
+		int score = alphabeta(child, depth-1, ply+1, !player, frame.alpha, frame.beta);
+		if (resumeSearchFrame(&frame, score)){
+			break;
+		}
+	}
+	finishSearchFrame(&frame);
+	return frame.extremum;
+}
+
 /*
  * Retrieves a position on the board (tile) from user input.
  */
@@ -139,7 +385,7 @@ int readTile(char* str, int* x, int* y){
  */
 int pieceIsPawn(int x, int y){
 	char piece = Board_getPiece(&board, x, y);
-	return toBlack(piece) == Board_BLACK_PAWN; 
+	return Board_TYPE_OF(piece) == Board_PAWN; 
 }
 
 /*
@@ -160,6 +406,7 @@ int stringToColor(char* str){
  * 
  * @params: (str) - pointer to a user input string
  *			(color) - the relevant player's color
+ * @return: the piece, 0 if (str) names no piece
  */
 char stringToPiece(char* str, int color){
 	char piece = 0;
@@ -181,7 +428,7 @@ char stringToPiece(char* str, int color){
 	if (str_equals(str, "king")){
 		piece = Board_WHITE_KING;
 	}
-	if (color == BLACK){
+	if (piece && color == BLACK){
 		piece = toBlack(piece);
 	}
 	return piece;
@@ -284,6 +531,72 @@ int setGameMode(char* command){
 	return 0;
 }
 
+/*
+ * Handles the "eval_cache" command, which sets the number of positions the evaluation cache holds.
+ *
+ * @return: -1 if the input was not formatted legally or the size is out of range
+ *			-14 if there is not enough memory for a cache of that size, in which case the current one is kept
+ *			 0 otherwise
+ */
+int setEvalCacheSize(char* command){
+	int numOfEntries;
+	if (sscanf(command, "eval_cache %d", &numOfEntries) != 1 || numOfEntries < 1 || numOfEntries > EvalCache_MAX_SIZE){
+		return -1;
+	}
+	if (EvalCache_setSize(numOfEntries)){
+		return -14;
+	}
+	return 0;
+}
+
+/*
+ * Handles the "nnue" command, which switches the neural network evaluation on or off.
+ *
+ * @return: -1 if the input was not formatted legally
+ *			-13 if the network's weights were not loaded
+ *			 0 otherwise
+ */
+int setNeuralNetwork(char* command){
+	char value[4];
+	if (sscanf(command, "nnue %3s", value) != 1){
+		return -1;
+	}
+	if (str_equals(value, "off")){
+		useNeuralNetwork = 0;
+		return 0;
+	}
+	if (!str_equals(value, "on")){
+		return -1;
+	}
+	if (!Nnue_isLoaded()){
+		return -13;
+	}
+	useNeuralNetwork = 1;
+	return 0;
+}
+
+/*
+ * Handles the "ponder" command, which switches on or off the computer's searching while the player thinks.
+ *
+ * @return: -1 if the input was not formatted legally
+ *			 0 otherwise
+ */
+int setPondering(char* command){
+	char value[4];
+	if (sscanf(command, "ponder %3s", value) != 1){
+		return -1;
+	}
+	if (str_equals(value, "off")){
+		usePondering = 0;
+		return 0;
+	}
+	if (!str_equals(value, "on")){
+		return -1;
+	}
+	usePondering = 1;
+	return 0;
+}
+
 /*
  * Main function for handling the "difficulty" command for setting the difficulty level during the settings stage. 
  *
@@ -433,7 +746,7 @@ PossibleMove* readMove(char* command, int* exitcode){
 	}
 	
 	if(pieceIsPawn(fromX, fromY) && Board_isFurthestRowForPlayer(turn, toY) && promoteTo == 0){
-		promoteTo = (turn = WHITE)? 'q':'Q';        //default promotion
+		promoteTo = Board_PIECE(Board_QUEEN, turn);        //default promotion
 	}
 	
 	if (!Board_isInRange(fromX, fromY) 
@@ -458,13 +771,13 @@ PossibleMove* readMove(char* command, int* exitcode){
 void printBoardArrays(){
 	printf("kingMovementArray: ");
 	for (int i = 0; i <= 1; i++){
-		printf("%d", board.hasKingEverMoved[i]);
+		printf("%d", Board_hasKingEverMoved(&board, i));
 	}
 	printf("\nRookMovementArray:");
 	
 	for (int i = 0; i <= 1; i++){
 		for (int j = 0; j <= 1; j++){
-			printf("%d", board.hasRookEverMoved[i][j]);
+			printf("%d", Board_hasRookEverMoved(&board, i, j));
 		}
 	}
 	printf("\n");
@@ -499,174 +812,933 @@ int movePiece(char* command){
 		PossibleMoveList_free(possibleMoves);
 		return -6;
 	}
-	
-	Board_copy(&board, move->board);
-	display();
-	PossibleMove_free(move);
-	PossibleMoveList_free(possibleMoves);
-	turn = !turn;
+	
+	Board_copy(&board, move->board);
+	display();
+	PossibleMove_free(move);
+	PossibleMoveList_free(possibleMoves);
+	turn = !turn;
+	return 0;
+}
+
+int castleRook(char* command){
+	char rookTile[6];
+	if (sscanf(command, "castle %5s", rookTile) != 1){
+		return -1;
+	}
+	int rookX, rookY;
+	if (readTile(rookTile, &rookX, &rookY) == -1){
+		return -1;
+	}
+	if (!Board_isInRange(rookX, rookY)){
+		return -2;
+	}
+	if (Board_getColor(&board, rookX, rookY) != turn){
+		return -5;
+	}
+	if(!pieceIsRook(&board, rookX, rookY)){
+		return -11;
+	}
+	PossibleMove* castlingMove = PossibleMove_new(rookX, rookY, 0, 0, 0, &board);
+	if (!castlingMove){
+		return 1;
+	}
+	
+	LinkedList* possibleMoves = Board_getPossibleMovesOfPiece(&board, rookX, rookY, 0);
+	if (!possibleMoves){
+		PossibleMove_free(castlingMove);
+		return 1;
+	}
+	
+	if (!PossibleMoveList_contains(possibleMoves, castlingMove)){
+		PossibleMove_free(castlingMove);
+		PossibleMoveList_free(possibleMoves);
+		return -12;
+	}
+	
+	Board_copy(&board, castlingMove->board);
+	display();
+	PossibleMove_free(castlingMove);
+	PossibleMoveList_free(possibleMoves);
+	turn = !turn;
+	return 0;
+}
+
+int computeBestDepth(Board* position, int player){
+	int depth = 0;
+	int switcher = 1;
+	int bound = 1;
+	int upperBoundCurrentPlayer = Board_getUpperBoundMoves(position, player);
+	int upperBoundOpponent = Board_getUpperBoundMoves(position, !player);
+	while (bound <= 1000000){
+		if (switcher){
+			bound *= upperBoundCurrentPlayer;
+		}
+		else {
+			bound *= upperBoundOpponent;
+		}
+		depth += 1;
+		switcher = !switcher;
+	}
+	return depth;
+}
+
+int printBestMoves(char* command){
+	int depth;
+	if (command[15] == 'b'){
+		depth = computeBestDepth(&board, turn);
+	}
+	else{
+		if (sscanf(command, "get_best_moves %d", &depth) != 1){
+			return -1;
+		}
+	}
+	
+	LinkedList* allPossibleMoves = Board_getPossibleMoves(&board, turn);
+	if (!allPossibleMoves){
+		return 1;
+	}
+	searchPlayer = turn;
+	int bestScore = INT_MIN;
+	Iterator iterator;
+	Iterator_init(&iterator, allPossibleMoves);
+	LinkedList* bestMoves = PossibleMoveList_new();
+	if (!bestMoves){
+		PossibleMoveList_free(allPossibleMoves);
+		return 1;
+	}
+	while(Iterator_hasNext(&iterator)){
+		PossibleMove* currentMove = (PossibleMove*)Iterator_next(&iterator);
+		// moves that cannot tie the best score so far only need to be proven worse
+		int alpha = (bestScore == INT_MIN)? INT_MIN: bestScore-1;
+		int score = alphabeta(currentMove, depth, 1, !turn, alpha, INT_MAX);
+		if (score > bestScore) {
+			LinkedList_removeAll(bestMoves);
+			if(LinkedList_add(bestMoves, currentMove)){
+				LinkedList_removeAll(bestMoves);
+				LinkedList_free(bestMoves);
+				PossibleMoveList_free(allPossibleMoves);
+				return 1;
+			}
+			bestScore = score;
+		}
+		else if (score == bestScore){
+			if(LinkedList_add(bestMoves, currentMove)){
+				LinkedList_removeAll(bestMoves);
+				LinkedList_free(bestMoves);		
+				PossibleMoveList_free(allPossibleMoves);
+				return 1;
+			}
+		}
+	}
+	PossibleMoveList_print(bestMoves);
+	LinkedList_removeAll(bestMoves);	//removes the nodes
+	LinkedList_free(bestMoves);			//frees the struct
+	LinkedList_free(allPossibleMoves);	//frees the moves
+	return 0;
+}
+
+/*
+ * Prints the static exchange evaluation of a capture, 
+ * that is how much material it wins once all recaptures on its square have been made.
+ */
+int printStaticExchange(char* command){
+	int exitcode;
+	PossibleMove* move = readMove(command + 4, &exitcode);
+	if (exitcode != 0){ // illegal input or illegal move
+		return exitcode;
+	}
+	printf("%d\n", Board_getExactStaticExchange(&board, move->fromX, move->fromY, move->toX, move->toY));
+	PossibleMove_free(move);
+	return 0;
+}
+
+/*
+ * Counts the leaves of the move tree of a given depth, below a given board.
+ *
+ * @return: the number of leaves, -1 if an allocation error occurred
+ */
+long countLeaves(Board* position, int depth, int player){
+	LinkedList* possibleMoves = Board_getPossibleMoves(position, player);
+	if (!possibleMoves){
+		return -1;
+	}
+	long leaves = 0;
+	if (depth == 1){
+		leaves = LinkedList_length(possibleMoves);
+	}
+	else{
+		Iterator iterator;
+		Iterator_init(&iterator, possibleMoves);
+		while (Iterator_hasNext(&iterator)){
+			PossibleMove* currentMove = (PossibleMove*)Iterator_next(&iterator);
+			long subtreeLeaves = countLeaves(currentMove->board, depth-1, !player);
+			if (subtreeLeaves == -1){
+				PossibleMoveList_free(possibleMoves);
+				return -1;
+			}
+			leaves += subtreeLeaves;
+		}
+	}
+	PossibleMoveList_free(possibleMoves);
+	return leaves;
+}
+
+/*
+ * Benchmarks the move generator by counting all move sequences of a given depth 
+ * from the current board, and prints the count and the time it took.
+ */
+int printPerft(char* command){
+	int depth;
+	if (sscanf(command, "perft %d", &depth) != 1 || depth < 1){
+		return -1;
+	}
+	clock_t start = clock();
+	long leaves = countLeaves(&board, depth, turn);
+	if (leaves == -1){
+		return 1;
+	}
+	double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+	printf("%ld moves in %.3f seconds\n", leaves, seconds);
+	return 0;
+}
+
+/*
+ * Searches for a forced mate of the current player within a given number of moves,
+ * and prints the mating line or that there is none.
+ */
+int printMate(char* command){
+	int maxMoves;
+	if (sscanf(command, "mate %d", &maxMoves) != 1 || maxMoves < 1){
+		return -1;
+	}
+	LinkedList* line = PossibleMoveList_new();
+	if (!line){
+		return 1;
+	}
+	int moves = MateSolver_solve(&board, turn, maxMoves, line);
+	if (moves == -1){
+		PossibleMoveList_free(line);
+		return 1;
+	}
+	if (moves == 0){
+		printf("No mate in %d\n", maxMoves);
+	}
+	else{
+		printf("Mate in %d\n", moves);
+		PossibleMoveList_print(line);
+	}
+	PossibleMoveList_free(line);
+	return 0;
+}
+
+/*
+ * Prints how often the evaluation found what it needed in its caches.
+ */
+int printStatistics(){
+	long probes, hits;
+	Board_getPawnHashStats(&probes, &hits);
+	printf("Pawn hash: %ld hits in %ld probes (%.1f%%)\n", hits, probes, (probes > 0)? 100.0*hits/probes: 0.0);
+	long misses;
+	EvalCache_getStats(&hits, &misses);
+	probes = hits + misses;
+	printf("Evaluation cache: %ld hits in %ld probes (%.1f%%)\n", hits, probes, (probes > 0)? 100.0*hits/probes: 0.0);
+	return 0;
+}
+
+/*
+ * Measures how many boards per second each scoring function evaluates, on the boards one move away from the current one.
+ * The network is measured both summing its accumulator from scratch and updating it from the current board's,
+ * and the material sum with each implementation this processor supports.
+ */
+int printEvaluationSpeed(){
+	LinkedList* possibleMoves = Board_getPossibleMoves(&board, turn);
+	if (!possibleMoves){
+		return 1;
+	}
+	const char* names[] = {"Board_getScore", "Board_getBetterScore", "NNUE from scratch", "NNUE incremental"};
+	int numOfFunctions = (Nnue_isLoaded())? 4: 2;
+	for (int function = 0; function < numOfFunctions; function++){
+		long numOfEvaluations = 0;
+		volatile int sum = 0;
+		clock_t start = clock();
+		clock_t end = start;
+		while (end - start < CLOCKS_PER_SEC/2){
+			Iterator iterator;
+			Iterator_init(&iterator, possibleMoves);
+			while (Iterator_hasNext(&iterator)){
+				Board* child = ((PossibleMove*)Iterator_next(&iterator))->board;
+				switch (function){
+					case 0: sum += Board_getScore(child, turn, !turn); break;
+					case 1: sum += Board_getBetterScore(child, turn, !turn); break;
+					case 2: sum += Nnue_evaluateFromScratch(child, !turn); break;
+					case 3: 
+						Nnue_evaluate(&board, turn, 0);
+						sum += Nnue_evaluate(child, !turn, 1); 
+						break;
+				}
+				numOfEvaluations++;
+			}
+			end = clock();
+		}
+		printf("%s: %.0f evaluations per second\n", names[function], numOfEvaluations*(double)CLOCKS_PER_SEC/(end - start));
+	}
+	const char* materialNames[] = {"Material loop", "Material SSSE3", "Material AVX2"};
+	for (int implementation = Board_MATERIAL_LOOP; implementation <= Board_MATERIAL_AVX2; implementation++){
+		Board_MaterialFunction getMaterial = Board_getMaterialFunction(implementation);
+		if (!getMaterial){
+			printf("%s: not supported\n", materialNames[implementation]);
+			continue;
+		}
+		long numOfEvaluations = 0;
+		volatile int sum = 0;
+		clock_t start = clock();
+		clock_t end = start;
+		while (end - start < CLOCKS_PER_SEC/2){
+			for (int i = 0; i < 1000; i++){
+				Iterator iterator;
+				Iterator_init(&iterator, possibleMoves);
+				while (Iterator_hasNext(&iterator)){
+					sum += getMaterial(((PossibleMove*)Iterator_next(&iterator))->board);
+					numOfEvaluations++;
+				}
+			}
+			end = clock();
+		}
+		printf("%s: %.0f evaluations per second\n", materialNames[implementation], numOfEvaluations*(double)CLOCKS_PER_SEC/(end - start));
+	}
+	LinkedList_free(possibleMoves);
+	return 0;
+}
+
+int getDepth(Board* position, int player){
+	return (maxRecursionDepth == BEST)? computeBestDepth(position, player): maxRecursionDepth;
+}
+
+/*
+ * The root of the search: the moves of the player to move, each searched in turn by alphabeta or by the stepped search.
+ */
+typedef struct RootSearch{
+	int player;
+	int depth;
+	LinkedList* moves;
+	Iterator iterator;
+	PossibleMove* move;
+	PossibleMove* bestMove;
+	int bestScore;
+} RootSearch;
+
+/*
+ * Prepares the search for the move of (player) on (position). If the book has a move, it is the best move
+ * and there is nothing to search.
+ *
+ * @return: 1 if an allocation error occurred, 0 otherwise
+ */
+int initRootSearch(RootSearch* root, Board* position, int player){
+	searchPlayer = player;
+	root->player = player;
+	root->moves = NULL;
+	root->bestMove = NULL;
+	root->bestScore = INT_MIN;
+	if (Book_getMove(position, player, &root->bestMove)){
+		return 1;
+	}
+	if (root->bestMove){
+		return 0;
+	}
+	root->moves = Board_getPossibleMoves(position, player);
+	if (!root->moves){
+		return 1;
+	}
+	root->depth = getDepth(position, player);
+	Iterator_init(&root->iterator, root->moves);
+	return 0;
+}
+
+/*
+ * @params: (alpha) - set to the alpha to search the move with
+ * @return: the next move of the root to search, NULL if all of them were searched, 
+ *          in which case the moves other than the best one are freed
+ */
+PossibleMove* getNextRootMove(RootSearch* root, int* alpha){
+	if (!root->moves){
+		return NULL;
+	}
+	if (!Iterator_hasNext(&root->iterator)){
+		LinkedList_freeAllButOne(root->moves, root->bestMove);
+		root->moves = NULL;
+		return NULL;
+	}
+	root->move = (PossibleMove*)Iterator_next(&root->iterator);
+	// moves that cannot tie the best score so far only need to be proven worse
+	*alpha = (root->bestScore == INT_MIN)? INT_MIN: root->bestScore-1;
+	return root->move;
+}
+
+/*
+ * Takes the (score) of the root move last searched.
+ */
+void takeRootScore(RootSearch* root, int score){
+	if (score > root->bestScore || (score == root->bestScore && rand()%2)) {
+		root->bestScore = score;
+		root->bestMove = root->move;
+	}
+}
+
+/*
+ * Finds the move the computer plays for (player) on (position). (player) must be the side to move on (position).
+ *
+ * @return: the move, NULL if an allocation error occurred
+ */
+PossibleMove* getBestMove(Board* position, int player){
+	RootSearch root;
+	if (initRootSearch(&root, position, player)){
+		return NULL;
+	}
+	int alpha;
+	PossibleMove* move;
+	while ((move = getNextRootMove(&root, &alpha))){
+		takeRootScore(&root, alphabeta(move, root.depth, 1, !player, alpha, INT_MAX));
+	}
+	return root.bestMove;
+}
+
+/*
+ * The stepped search: the search of getBestMove, with the recursion of alphabeta kept as explicit 
+ * data so that it can be run for a bounded number of nodes at a time and resumed later. 
+ */
+#define MAX_SEARCH_FRAMES 64
+
+typedef struct SteppedSearch{
+	RootSearch root;
+	SearchFrame frames[MAX_SEARCH_FRAMES];
+	int numOfFrames;
+	int hasScore; // a node was just scored, with (score), and its parent has yet to take it
+	int score;
+} SteppedSearch;
+
+/*
+ * Pushes a frame for searching (possibleMove) and enters it. A frame scored on entry is popped at once.
+ */
+void pushSearchFrame(SteppedSearch* search, PossibleMove* possibleMove, int depth, int ply, int player, int alpha, int beta){
+	SearchFrame* frame = &search->frames[search->numOfFrames++];
+	frame->possibleMove = possibleMove;
+	frame->depth = depth;
+	frame->ply = ply;
+	frame->player = player;
+	frame->alpha = alpha;
+	frame->beta = beta;
+	if (enterSearchFrame(frame)){
+		search->numOfFrames--;
+		search->score = frame->extremum;
+		search->hasScore = 1;
+	}
+}
+
+/*
+ * Prepares a stepped search for the move of (player) on (position), which must outlive the search.
+ *
+ * @return: 1 if an allocation error occurred, 0 otherwise
+ */
+int initSteppedSearch(SteppedSearch* search, Board* position, int player){
+	search->numOfFrames = 0;
+	search->hasScore = 0;
+	if (initRootSearch(&search->root, position, player)){
+		return 1;
+	}
+	search->root.depth = (search->root.depth < MAX_SEARCH_FRAMES)? search->root.depth: MAX_SEARCH_FRAMES;
+	return 0;
+}
+
+/*
+ * Runs a stepped search for at most (budget) nodes. 
+ * Once it is done, the move found is in (search->root.bestMove), and belongs to the caller.
+ *
+ * @return: 1 if the search is done, 0 if it needs more steps
+ */
+int stepSearch(SteppedSearch* search, long budget){
+	RootSearch* root = &search->root;
+	while (budget > 0 || search->hasScore){
+		if (search->hasScore){
+			search->hasScore = 0;
+			if (search->numOfFrames == 0){ // a move of the root was scored
+				takeRootScore(root, search->score);
+				continue;
+			}
+			SearchFrame* frame = &search->frames[search->numOfFrames-1];
+			if (resumeSearchFrame(frame, search->score)){
+				finishSearchFrame(frame);
+				search->numOfFrames--;
+				search->score = frame->extremum;
+				search->hasScore = 1;
+			}
+			continue;
+		}
+		budget--;
+		if (search->numOfFrames == 0){
+			int alpha;
+			PossibleMove* move = getNextRootMove(root, &alpha);
+			if (!move){
+				return 1;
+			}
+			pushSearchFrame(search, move, root->depth, 1, !root->player, alpha, INT_MAX);
+			continue;
+		}
+		SearchFrame* frame = &search->frames[search->numOfFrames-1];
+		PossibleMove* child = getNextChildOfSearchFrame(frame);
+		if (!child){
+			finishSearchFrame(frame);
+			search->numOfFrames--;
+			search->score = frame->extremum;
+			search->hasScore = 1;
+			continue;
+		}
+		pushSearchFrame(search, child, frame->depth-1, frame->ply+1, !frame->player, frame->alpha, frame->beta);
+	}
+	return 0;
+}
+
+/*
+ * Abandons a stepped search that is not done, freeing what it holds.
+ */
+void freeSteppedSearch(SteppedSearch* search){
+	while (search->numOfFrames > 0){
+		MoveGenerator_free(&search->frames[--search->numOfFrames].generator);
+	}
+	if (search->root.moves){
+		LinkedList_free(search->root.moves);
+		search->root.moves = NULL;
+	}
+	else if (search->root.bestMove){ // a book move
+		PossibleMove_free(search->root.bestMove);
+	}
+	search->root.bestMove = NULL;
+}
+
+/*
+ * The legal moves of the player to move on the game board, generated once per position 
+ * and indexed by the squares they are from and to, so that the GUI looks moves up rather than generating them.
+ * Castling moves are indexed by the square of their rook. 
+ * Of the four moves of a promotion, the one to a queen is indexed, since the piece is chosen after the move.
+ * (movesOfSelectedPiece) only holds moves of this table, and is dropped when the table is generated again.
+ */
+typedef struct LegalMoves{
+	Board board;
+	int player;
+	LinkedList* list;
+	PossibleMove* moves[64][64];
+	PossibleMove* castlingMoves[64];
+	int numOfMoves;
+} LegalMoves;
+
+LegalMoves legalMoves;
+
+/*
+ * Deselects the selected piece and its moves.
+ */
+void clearSelection(){
+	if (movesOfSelectedPiece){
+		LinkedList_removeAll(movesOfSelectedPiece);
+		free(movesOfSelectedPiece);
+		movesOfSelectedPiece = NULL;
+	}
+	selectedX = 0;
+}
+
+/*
+ * @return: the legal moves on the game board, generated again only if the board or the turn changed, 
+ *          NULL if an allocation error occurred
+ */
+LegalMoves* getLegalMoves(){
+	if (legalMoves.list && legalMoves.player == turn && !memcmp(&legalMoves.board, &board, sizeof(Board))){
+		return &legalMoves;
+	}
+	clearSelection();
+	if (legalMoves.list){
+		PossibleMoveList_free(legalMoves.list);
+	}
+	memset(legalMoves.moves, 0, sizeof(legalMoves.moves));
+	memset(legalMoves.castlingMoves, 0, sizeof(legalMoves.castlingMoves));
+	legalMoves.list = PossibleMoveList_new();
+	if (!legalMoves.list){
+		return NULL;
+	}
+	for (int x = 1; x <= Board_SIZE; x++){
+		for (int y = 1; y <= Board_SIZE; y++){
+			if (Board_getColor(&board, x, y) != turn){
+				continue;
+			}
+			// castling moves are the king's, and are not generated again with the rooks' 
+			int isRook = (Board_getPiece(&board, x, y) == Board_PIECE(Board_ROOK, turn));
+			LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(&board, x, y, isRook);
+			if (!pieceMoves){
+				PossibleMoveList_free(legalMoves.list);
+				legalMoves.list = NULL;
+				return NULL;
+			}
+			LinkedList_concatenateAndFree(legalMoves.list, pieceMoves);
+		}
+	}
+	Board_copy(&legalMoves.board, &board);
+	legalMoves.player = turn;
+	legalMoves.numOfMoves = LinkedList_length(legalMoves.list);
+	Iterator iterator;
+	Iterator_init(&iterator, legalMoves.list);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
+		int from = Board_SQUARE(move->fromX, move->fromY);
+		if (move->toX == 0){
+			legalMoves.castlingMoves[from] = move;
+			continue;
+		}
+		PossibleMove** entry = &legalMoves.moves[from][Board_SQUARE(move->toX, move->toY)];
+		if (!*entry || Board_TYPE_OF(move->promotion) == Board_QUEEN){
+			*entry = move;
+		}
+	}
+	return &legalMoves;
+}
+
+/*
+ * Finds the legal move of the piece on <fromX,fromY> to <toX,toY>.
+ * Castling is either a move of the rook to any square, or a move of the king to the rook.
+ *
+ * @return: the move, NULL if there is none
+ */
+PossibleMove* findLegalMove(LegalMoves* legal, int fromX, int fromY, int toX, int toY){
+	if (!Board_isInRange(fromX, fromY)){
+		return NULL;
+	}
+	int from = Board_SQUARE(fromX, fromY);
+	if (Board_isInRange(toX, toY)){
+		int to = Board_SQUARE(toX, toY);
+		if (legal->moves[from][to]){
+			return legal->moves[from][to];
+		}
+		// castle move, king was selected
+		if (legal->castlingMoves[to] && from == legal->board.kingSquare[legal->player]){
+			return legal->castlingMoves[to];
+		}
+	}
+	// castle move, rook was selected
+	return legal->castlingMoves[from];
+}
+
+/*
+ * Selects the piece on <x,y>, showing its legal moves.
+ * @return: 1 if an allocation error occurred, 0 otherwise
+ */
+int selectPiece(int x, int y){
+	LegalMoves* legal = getLegalMoves();
+	if (!legal){
+		return 1;
+	}
+	clearSelection();
+	movesOfSelectedPiece = PossibleMoveList_new();
+	if (!movesOfSelectedPiece){
+		return 1;
+	}
+	selectedX = x;
+	selectedY = y;
+	if (!Board_isInRange(x, y)){
+		return 0;
+	}
+	int from = Board_SQUARE(x, y);
+	int isKing = (from == legal->board.kingSquare[legal->player]);
+	for (int to = 0; to < Board_SIZE*Board_SIZE; to++){
+		PossibleMove* move = legal->moves[from][to];
+		if (!move && (to == from || isKing)){
+			move = legal->castlingMoves[to];
+		}
+		if (move && LinkedList_add(movesOfSelectedPiece, move)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Selects the piece (move) is of, showing only the legal move (move) describes.
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+int selectMove(PossibleMove* move){
+	LegalMoves* legal = getLegalMoves();
+	if (!legal){
+		return -1;
+	}
+	clearSelection();
+	int from = Board_SQUARE(move->fromX, move->fromY);
+	PossibleMove* legalMove = (move->toX == 0)? legal->castlingMoves[from]: legal->moves[from][Board_SQUARE(move->toX, move->toY)];
+	if (!legalMove){
+		return 0;
+	}
+	movesOfSelectedPiece = PossibleMoveList_new();
+	if (!movesOfSelectedPiece){
+		return -1;
+	}
+	selectedX = move->fromX;
+	selectedY = move->fromY;
+	if (LinkedList_add(movesOfSelectedPiece, legalMove)){
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Selects (move) on the board as a hint.
+ */
+int setSelectedMove(PossibleMove* move){
+	int error = selectMove(move);
+	PossibleMove_free(move);
+	return error;
+}
+
+/*
+ * The search for the computer's move or for a hint, run on a worker thread in GUI mode 
+ * so that the window stays responsive. It searches a private copy of the board.
+ * Only one runs at a time, and it is cancelled before anything it depends on changes.
+ * Builds with SINGLE_THREADED defined run it as a stepped search instead, 
+ * a batch of SEARCH_STEP_NODES nodes at a time while the GUI waits for events.
+ *
+ * While the player thinks, the computer ponders: it searches its reply to the move it predicts 
+ * the player will make. If the player makes that move, the search goes on as the computer's search, 
+ * otherwise it is cancelled, and only the caches it filled are kept.
+ */
+#define SEARCH_STEP_NODES 2000
+#define SEARCH_MOVE 0
+#define SEARCH_HINT 1
+#define SEARCH_PONDER 2
+
+typedef struct BackgroundSearch{
+#ifdef SINGLE_THREADED
+	SteppedSearch steps;
+	int running;
+#else
+	SDL_Thread* thread;
+#endif
+	Board board;
+	int player;
+	int kind;
+	volatile int finished;
+	PossibleMove* result;
+} BackgroundSearch;
+
+BackgroundSearch backgroundSearch;
+
+#ifdef SINGLE_THREADED
+/*
+ * Runs the next batch of nodes of the search, and posts the event of its end once it is done.
+ */
+void stepBackgroundSearch(){
+	if (stepSearch(&backgroundSearch.steps, SEARCH_STEP_NODES)){
+		backgroundSearch.result = backgroundSearch.steps.root.bestMove;
+		backgroundSearch.finished = 1;
+		if (displayMode == GUI){
+			GUI_pushEvent(GUI_AI_DONE_EVENT);
+		}
+	}
+}
+
+int backgroundSearchIsRunning(){
+	return backgroundSearch.running;
+}
+#else
+int runBackgroundSearch(void* data){
+	backgroundSearch.result = getBestMove(&backgroundSearch.board, backgroundSearch.player);
+	backgroundSearch.finished = 1;
+	if (displayMode == GUI){
+		GUI_pushEvent(GUI_AI_DONE_EVENT);
+	}
 	return 0;
 }
 
-int castleRook(char* command){
-	char rookTile[6];
-	if (sscanf(command, "castle %5s", rookTile) != 1){
-		return -1;
-	}
-	int rookX, rookY;
-	if (readTile(rookTile, &rookX, &rookY) == -1){
-		return -1;
-	}
-	if (!Board_isInRange(rookX, rookY)){
-		return -2;
-	}
-	if (Board_getColor(&board, rookX, rookY) != turn){
-		return -5;
-	}
-	if(!pieceIsRook(&board, rookX, rookY)){
-		return -11;
-	}
-	PossibleMove* castlingMove = PossibleMove_new(rookX, rookY, 0, 0, 0, &board);
-	if (!castlingMove){
+int backgroundSearchIsRunning(){
+	return backgroundSearch.thread != NULL;
+}
+#endif
+
+/*
+ * Starts searching (position) on a worker thread, for the move of (player).
+ * @params: (kind) - SEARCH_MOVE, SEARCH_HINT or SEARCH_PONDER
+ * @return: 1 if the thread (or the stepped search) could not be created, 0 otherwise
+ */
+int startBackgroundSearch(Board* position, int player, int kind){
+	Board_copy(&backgroundSearch.board, position);
+	backgroundSearch.player = player;
+	backgroundSearch.kind = kind;
+	backgroundSearch.finished = 0;
+	backgroundSearch.result = NULL;
+	searchCancelled = 0;
+#ifdef SINGLE_THREADED
+	if (initSteppedSearch(&backgroundSearch.steps, &backgroundSearch.board, backgroundSearch.player)){
+		printf("ERROR: standard function malloc has failed\n");
 		return 1;
 	}
-	
-	LinkedList* possibleMoves = Board_getPossibleMovesOfPiece(&board, rookX, rookY, 0);
-	if (!possibleMoves){
-		PossibleMove_free(castlingMove);
+	backgroundSearch.running = 1;
+#else
+	backgroundSearch.thread = SDL_CreateThread(&runBackgroundSearch, NULL);
+	if (!backgroundSearch.thread){
+		printf("ERROR: failed to create thread: %s\n", SDL_GetError());
 		return 1;
 	}
-	
-	if (!PossibleMoveList_contains(possibleMoves, castlingMove)){
-		PossibleMove_free(castlingMove);
-		PossibleMoveList_free(possibleMoves);
-		return -12;
-	}
-	
-	Board_copy(&board, castlingMove->board);
-	display();
-	PossibleMove_free(castlingMove);
-	PossibleMoveList_free(possibleMoves);
-	turn = !turn;
+#endif
 	return 0;
 }
 
-int computeBestDepth(){
-	int depth = 0;
-	int switcher = 1;
-	int bound = 1;
-	int upperBoundCurrentPlayer = Board_getUpperBoundMoves(&board, turn);
-	int upperBoundOpponent = Board_getUpperBoundMoves(&board, !turn);
-	while (bound <= 1000000){
-		if (switcher){
-			bound *= upperBoundCurrentPlayer;
-		}
-		else {
-			bound *= upperBoundOpponent;
-		}
-		depth += 1;
-		switcher = !switcher;
+/*
+ * Stops the running search, if there is one, and waits for its thread to exit.
+ */
+void cancelBackgroundSearch(){
+	if (!backgroundSearchIsRunning()){
+		return;
+	}
+#ifdef SINGLE_THREADED
+	if (!backgroundSearch.finished){
+		freeSteppedSearch(&backgroundSearch.steps);
+	}
+	backgroundSearch.running = 0;
+#else
+	searchCancelled = 1;
+	SDL_WaitThread(backgroundSearch.thread, NULL);
+	backgroundSearch.thread = NULL;
+	searchCancelled = 0;
+#endif
+	if (backgroundSearch.result){
+		PossibleMove_free(backgroundSearch.result);
+		backgroundSearch.result = NULL;
 	}
-	return depth;
 }
 
-int printBestMoves(char* command){
-	int depth;
-	if (command[15] == 'b'){
-		depth = computeBestDepth();
+/*
+ * Waits for the running search to end.
+ * @return: the move it found, which belongs to the caller, NULL if an allocation error occurred
+ */
+PossibleMove* joinBackgroundSearch(){
+#ifdef SINGLE_THREADED
+	while (!backgroundSearch.finished){
+		stepBackgroundSearch();
+	}
+	backgroundSearch.running = 0;
+#else
+	SDL_WaitThread(backgroundSearch.thread, NULL);
+	backgroundSearch.thread = NULL;
+#endif
+	PossibleMove* move = backgroundSearch.result;
+	backgroundSearch.result = NULL;
+	return move;
+}
+
+/*
+ * Starts pondering, if the game is against the computer and it has not ended.
+ * The predicted move is the first the move generator gives, which is the best move 
+ * the computer's own search found for the player, when it searched deep enough to find one.
+ * @return: 1 if an allocation error occurred or the search could not be started, 0 otherwise
+ */
+int startPondering(){
+	if (!usePondering || gameMode != SINGLE_PLAYER_MODE){
+		return 0;
 	}
-	else{
-		if (sscanf(command, "get_best_moves %d", &depth) != 1){
-			return -1;
-		}
+#ifdef SINGLE_THREADED
+	// nothing would step the search while the console waits for a command
+	if (displayMode == CONSOLE){
+		return 0;
 	}
-	
-	LinkedList* allPossibleMoves = Board_getPossibleMoves(&board, turn);
-	if (!allPossibleMoves){
+#endif
+	MoveGenerator generator;
+	if (MoveGenerator_init(&generator, &board, turn)){
 		return 1;
 	}
-	int bestScore = INT_MIN;
-	Iterator iterator;
-	Iterator_init(&iterator, allPossibleMoves);
-	LinkedList* bestMoves = PossibleMoveList_new();
-	if (!bestMoves){
-		PossibleMoveList_free(allPossibleMoves);
-		return 1;
+	int error;
+	PossibleMove* predictedMove = MoveGenerator_next(&generator, &error);
+	int result = error;
+	if (!error && predictedMove){
+		result = startBackgroundSearch(predictedMove->board, !turn, SEARCH_PONDER);
 	}
-	while(Iterator_hasNext(&iterator)){
-		PossibleMove* currentMove = (PossibleMove*)Iterator_next(&iterator);
-		int score = alphabeta(currentMove, depth, !turn, INT_MIN, INT_MAX);
-		if (score > bestScore) {
-			LinkedList_removeAll(bestMoves);
-			if(LinkedList_add(bestMoves, currentMove)){
-				LinkedList_removeAll(bestMoves);
-				LinkedList_free(bestMoves);
-				PossibleMoveList_free(allPossibleMoves);
-				return 1;
-			}
-			bestScore = score;
-		}
-		else if (score == bestScore){
-			if(LinkedList_add(bestMoves, currentMove)){
-				LinkedList_removeAll(bestMoves);
-				LinkedList_free(bestMoves);		
-				PossibleMoveList_free(allPossibleMoves);
-				return 1;
-			}
-		}
+	MoveGenerator_free(&generator);
+	return result;
+}
+
+/*
+ * Called when the computer is to move while it ponders: keeps the search if it was on the current board, 
+ * as the computer's search, and cancels it otherwise.
+ */
+void stopPondering(){
+	if (!backgroundSearchIsRunning() || backgroundSearch.kind != SEARCH_PONDER){
+		return;
+	}
+	if (backgroundSearch.player == turn && !memcmp(&backgroundSearch.board, &board, sizeof(Board))){
+		backgroundSearch.kind = SEARCH_MOVE;
+	}
+	else{
+		cancelBackgroundSearch();
 	}
-	PossibleMoveList_print(bestMoves);
-	LinkedList_removeAll(bestMoves);	//removes the nodes
-	LinkedList_free(bestMoves);			//frees the struct
-	LinkedList_free(allPossibleMoves);	//frees the moves
-	return 0;
 }
 
-int getDepth(){
-	return (maxRecursionDepth == BEST)? computeBestDepth(): maxRecursionDepth;
+/*
+ * Cancels the running search if it is for a hint, which is dropped once the player picks a piece.
+ * Pondering goes on while the player moves.
+ */
+void cancelHint(){
+	if (backgroundSearchIsRunning() && backgroundSearch.kind == SEARCH_HINT){
+		cancelBackgroundSearch();
+	}
 }
 
-PossibleMove* getBestMove(){
-	LinkedList* allPossibleMoves = Board_getPossibleMoves(&board, turn);
-	if (!allPossibleMoves){
-		return NULL;
+/*
+ * Plays (move) for the computer, and starts pondering the player's reply.
+ */
+int playComputerMove(PossibleMove* move){
+	if (displayMode == CONSOLE){
+		printf("Computer: move ");
+		PossibleMove_print(move);
 	}
-	int depth = getDepth();
-	int bestScore = INT_MIN;
-	PossibleMove* bestMove;
-	Iterator iterator;
-	Iterator_init(&iterator, allPossibleMoves);
-	while(Iterator_hasNext(&iterator)){
-		PossibleMove* currentMove = (PossibleMove*)Iterator_next(&iterator);
-		int score = alphabeta(currentMove, depth, !turn, INT_MIN, INT_MAX);
-		if (score > bestScore || (score == bestScore && rand()%2)) {
-			bestScore = score;
-			bestMove = currentMove;
-		}
+
+	Board_update(&board, move);
+	PossibleMove_free(move);
+	turn = !turn;
+	if (display()){
+		return 1;
 	}
-	LinkedList_freeAllButOne(allPossibleMoves, bestMove);
-	return bestMove;
+	
+	return startPondering();
 }
 
-int setSelectedMoveToBest(){
-	if (movesOfSelectedPiece){
-		LinkedList_free(movesOfSelectedPiece);
+/*
+ * Handles the event the worker thread posts when its search is done: 
+ * plays the computer's move, or selects the hint.
+ * Events of searches that were cancelled are ignored, and so are those of pondering, 
+ * whose results wait for the player's move.
+ */
+int finishBackgroundSearch(){
+	if (!backgroundSearchIsRunning() || !backgroundSearch.finished || backgroundSearch.kind == SEARCH_PONDER){
+		return 0;
 	}
-	movesOfSelectedPiece = LinkedList_new(&PossibleMove_free);
-	if (!movesOfSelectedPiece){
-		return -1;
+	PossibleMove* move = joinBackgroundSearch();
+	if (!move){
+		return 1;
 	}
-	PossibleMove* bestMove = getBestMove();
-	if (!bestMove){
-		return -1;
+	if (backgroundSearch.kind == SEARCH_HINT){
+		return setSelectedMove(move);
 	}
-	selectedX = bestMove->fromX;
-	selectedY = bestMove->fromY;
-	if(LinkedList_add(movesOfSelectedPiece, bestMove)){
+	return playComputerMove(move);
+}
+
+/*
+ * Selects the first move of the shortest mate within MATE_HINT_MOVES moves, if there is one.
+ */
+int setSelectedMoveToMate(){
+	clearSelection();
+	LinkedList* line = PossibleMoveList_new();
+	if (!line){
 		return -1;
 	}
-	
-	return 0;
+	int moves = MateSolver_solve(&board, turn, MATE_HINT_MOVES, line);
+	int error = (moves == -1)? -1: 0;
+	if (moves > 0){
+		error = selectMove((PossibleMove*)LinkedList_first(line));
+	}
+	PossibleMoveList_free(line);
+	return error;
 }
 
 int printMoveValue(char* command){
@@ -674,7 +1746,7 @@ int printMoveValue(char* command){
 	int depth;
 	int bestOffset = 0;
 	if (command[10] == 'b'){
-		depth = computeBestDepth();
+		depth = computeBestDepth(&board, turn);
 		bestOffset = 3;
 	}
 	else{
@@ -687,13 +1759,14 @@ int printMoveValue(char* command){
 		return -1;
 	}
 	
+	searchPlayer = turn;
 	if (strstr(command, "move")){
 		PossibleMove* move = readMove(command + 12 + bestOffset, &exitcode);
 		if (exitcode != 0){ // illegal input or illegal move
 			return exitcode;
 		}
 		else{
-			int score = alphabeta(move, depth, !turn, INT_MIN, INT_MAX);
+			int score = alphabeta(move, depth, 1, !turn, INT_MIN, INT_MAX);
 			printf("%d\n", score);
 			PossibleMove_free(move);			
 		}
@@ -704,7 +1777,7 @@ int printMoveValue(char* command){
 		exitcode = readTile(command + 19, &rookX, &rookY); 
 		if (exitcode == 0){
 			PossibleMove* castlingMove = PossibleMove_new(rookX, rookY, 0, 0, 0, &board);
-			int score = alphabeta(castlingMove, depth, !turn, INT_MIN, INT_MAX);
+			int score = alphabeta(castlingMove, depth, 1, !turn, INT_MIN, INT_MAX);
 			printf("%d\n", score);
 			PossibleMove_free(castlingMove);	
 		}
@@ -725,8 +1798,8 @@ int loadGame(char path[]){
 	
 	// resetting movement arrays, assuming files loaded without info about them correspond 
 	// to a game where all of the kings and rooks have never moved  
-	memset((&board)->hasKingEverMoved, 0, sizeof((&board)->hasKingEverMoved));
-	memset((&board)->hasRookEverMoved, 0, sizeof((&board)->hasRookEverMoved[0][0]) * 2 * 2);
+	int hasKingEverMoved[2] = {0, 0};
+	int hasRookEverMoved[2][2] = {{0, 0}, {0, 0}};
 	
 	while(fgets(buff, 50, gameFile) != 0){
 		if (strstr (buff, "<next_turn>")){
@@ -773,8 +1846,8 @@ int loadGame(char path[]){
 		if (strstr(buff, "<row_")){
 			int y = (int)buff[7] - 48;
 			for (int x = 1; x <= 8; x++){
-				char piece = buff[8+x];
-				if (piece != '_'){
+				char piece = Board_charToPiece(buff[8+x]);
+				if (piece != Board_EMPTY){
 					Board_setPiece(&board, x, y, piece);
 					PieceCounter_update(counter, piece, 1, x, y);
 				}
@@ -786,19 +1859,20 @@ int loadGame(char path[]){
 		}
 		else if (strstr(buff, "kingMovementArray")){
 			for (int i = 21; i <= 22; i++){
-				(&board)->hasKingEverMoved[i-21] = buff[i]-48;
+				hasKingEverMoved[i-21] = buff[i]-48;
 			}
 		}
 		else if (strstr(buff, "rookMovementArray")){
 			for (int i = 21; i <= 22; i++){
-				(&board)->hasRookEverMoved[0][i-21] = buff[i]-48;
+				hasRookEverMoved[0][i-21] = buff[i]-48;
 			}
 			for (int i = 23; i <= 24; i++){
-				(&board)->hasRookEverMoved[1][i-23] = buff[i]-48;
+				hasRookEverMoved[1][i-23] = buff[i]-48;
 			}
 		}
 	}
 	fclose(gameFile);
+	Board_setCastlingHistory(&board, hasKingEverMoved, hasRookEverMoved);
 	if (display()){
 		return 1;
 	}
@@ -849,7 +1923,7 @@ int saveGame(char path[]){
 				fprintf(gameFile, "_");
 			}
 			else{ 
-				fprintf(gameFile, "%c", newPiece);
+				fprintf(gameFile, "%c", Board_pieceToChar(newPiece));
 			}
 		}
 		if (y != 1){
@@ -861,12 +1935,12 @@ int saveGame(char path[]){
 	}
 
 	for (int i = 0; i <= 1; i++){
-		fprintf(gameFile, "%d", (&board)->hasKingEverMoved[i]);
+		fprintf(gameFile, "%d", Board_hasKingEverMoved(&board, i));
 	}
 	fprintf(gameFile, "</kingMovementArray>\n\t\t<rookMovementArray>");
 	for (int i = 0; i <= 1; i++){
 		for (int j = 0; j <= 1; j++){
-			fprintf(gameFile, "%d", (&board)->hasRookEverMoved[i][j]);
+			fprintf(gameFile, "%d", Board_hasRookEverMoved(&board, i, j));
 		}
 	}
 	fprintf(gameFile, "</rookMovementArray>\n\t</general>\n</game>");
@@ -906,6 +1980,10 @@ int saveGameByCommand(char* command){
 int executeCommand(char* command){
 	char str[64];
 	sscanf(command, "%s", str);
+	// pondering only goes on through the player's move
+	if (!str_equals(str, "move") && !str_equals(str, "castle")){
+		cancelBackgroundSearch();
+	}
 	if (str_equals(str, "quit")){
 		exit(0);
 	}	
@@ -916,6 +1994,15 @@ int executeCommand(char* command){
 		if (str_equals(str, "difficulty")){
 			return setDifficulty(command);
 		}
+		if (str_equals(str, "eval_cache")){
+			return setEvalCacheSize(command);
+		}
+		if (str_equals(str, "nnue")){
+			return setNeuralNetwork(command);
+		}
+		if (str_equals(str, "ponder")){
+			return setPondering(command);
+		}
 		if (str_equals(str, "user_color")){
 			return setUserColor(command);
 		}
@@ -945,6 +2032,7 @@ int executeCommand(char* command){
 				return -7;
 			}	
 			turn = first;
+			Board_setSideToMove(&board, turn);
 			state = GAME;
 			return 2; //special value to break the humanTurn loop so the initial board will always be checked for immediate loss or tie conditions
 		}
@@ -968,6 +2056,21 @@ int executeCommand(char* command){
 		if (str_equals(str,"save")){
 			return saveGameByCommand(command);
 		}
+		if (str_equals(str, "perft")){
+			return printPerft(command);
+		}
+		if (str_equals(str, "see")){
+			return printStaticExchange(command);
+		}
+		if (str_equals(str, "mate")){
+			return printMate(command);
+		}
+		if (str_equals(str, "stats")){
+			return printStatistics();
+		}
+		if (str_equals(str, "bench_eval")){
+			return printEvaluationSpeed();
+		}
 	}
 	return -1;
 }
@@ -993,31 +2096,33 @@ void printError(int error){
 		case -10:printf("Error: standard function fprintf has failed\n"); break;
 		case -11:printf("Wrong position for a rook\n"); break;
 		case -12:printf("Illegal castling move\n"); break;
+		case -13:printf("Neural network weights not found\n"); break;
+		case -14:printf("Not enough memory for an evaluation cache of this size\n"); break;
 	}
 }
 
 /*
- * The computer turn procedure.
+ * The computer turn procedure. 
+ * In GUI mode the search runs on a worker thread while the window keeps handling events,
+ * and the move is played when the search is done.
  */
 int computerTurn(){
-	PossibleMove* bestMove = getBestMove();
+	stopPondering();
+	if (displayMode == GUI){
+		if (!backgroundSearchIsRunning() && startBackgroundSearch(&board, turn, SEARCH_MOVE)){
+			return 1;
+		}
+		// a search that pondered on the player's move may be done already
+		if (backgroundSearch.finished){
+			return finishBackgroundSearch();
+		}
+		return humanTurnGUI(turn);
+	}
+	PossibleMove* bestMove = (backgroundSearchIsRunning())? joinBackgroundSearch(): getBestMove(&board, turn);
 	if (!bestMove){
 		allocationFailed();
 	}
-	
-	if (displayMode == CONSOLE){
-		printf("Computer: move ");
-		PossibleMove_print(bestMove);
-	}
-
-	Board_update(&board, bestMove);
-	PossibleMove_free(bestMove);
-	turn = !turn;
-	if (display()){
-		return 1;
-	}
-	
-	return 0;
+	return playComputerMove(bestMove);
 }
 
 void humanTurnConsole(int player){
@@ -1087,7 +2192,7 @@ int executeButton(int buttonId){
 			if (gameEnded){
 				return 0;
 			}
-			return setSelectedMoveToBest();
+			return startBackgroundSearch(&board, turn, SEARCH_HINT);
 		case QUIT: exit(0); break;
 		case INSTRUCTIONS: return setScreenToInstructions();
 		case CLEAR: Board_clear(copyOfMainBoard); PieceCounter_reset(copyOfMainPieceCounter); settingInvalidPiece = 0; return 0;
@@ -1140,79 +2245,33 @@ void convertPixelsToBoardPosition(SDL_Event e, int* tileX, int* tileY){
 }   
 
 int leftMouseButtonUp(SDL_Event e){
-	convertPixelsToBoardPosition(e, &selectedX, &selectedY);
-	if (movesOfSelectedPiece){
-		LinkedList_free(movesOfSelectedPiece);
-		movesOfSelectedPiece = NULL;
-	}
-	movesOfSelectedPiece = Board_getPossibleMovesOfPiece(&board, selectedX, selectedY, 0);
-	if (!movesOfSelectedPiece){
-		return 1;
-	}
-	
-	return 0;
+	int x, y;
+	convertPixelsToBoardPosition(e, &x, &y);
+	return selectPiece(x, y);
 }
 
 int rightMouseButtonUp(SDL_Event e){
 	chosePromotionMove = 0;
 	int x, y;
 	convertPixelsToBoardPosition(e, &x, &y);
-	if (!Board_getColor(&board, selectedX, selectedY) == turn){
-		return 0;
-	}
-	int legalMove = 0;
-	
-	char promoteTo = 0;
-	if(pieceIsPawn(selectedX, selectedY) && Board_isFurthestRowForPlayer(turn, y)){
-		promoteTo = (turn == WHITE)? 'q':'Q';        //default promotion
-		chosePromotionMove = 1;
-	}
-	PossibleMove* move = PossibleMove_new(selectedX, selectedY, x, y, promoteTo, &board);
-	if (!move){
+	LegalMoves* legal = getLegalMoves();
+	if (!legal){
 		return 1;
 	}
-	
-	while(1){
-		if (PossibleMoveList_contains(movesOfSelectedPiece, move)){
-			legalMove = 1;
-			break;
-		}
-		PossibleMove_free(move);
-		// castle move, rook eas selected
-		move = PossibleMove_new(selectedX, selectedY, 0, 0, 0, &board);
-		if (!move){
-			return 1;
-		}
-		if (PossibleMoveList_contains(movesOfSelectedPiece, move)){
-			legalMove = 1;
-			break;
-		}
-		PossibleMove_free(move);
-		// castle move, king was selected
-		move = PossibleMove_new(x, y, 0, 0, 0, &board);
-		if (!move){
-			return 1;
-		}
-		if (PossibleMoveList_contains(movesOfSelectedPiece, move)){
-			legalMove = 1;
-			break;
-		}
-		break;
+	PossibleMove* move = findLegalMove(legal, selectedX, selectedY, x, y);
+	if (!move){
+		return 0;
 	}
-	
-	if (legalMove){
-		lastDestinationTileX = move->toX;
-		lastDestinationTileY = move->toY;
-		Board_copy(&board, move->board);
-		PossibleMoveList_free(movesOfSelectedPiece);
-		movesOfSelectedPiece = NULL;
-		selectedX = 0;
-		isInCheck = 0;
-		if (!chosePromotionMove){
-			turn = !turn;
-		}
+	// a pawn is promoted to a queen, until the player chooses the piece
+	chosePromotionMove = (move->promotion != 0);
+	lastDestinationTileX = move->toX;
+	lastDestinationTileY = move->toY;
+	Board_copy(&board, move->board);
+	clearSelection();
+	isInCheck = 0;
+	if (!chosePromotionMove){
+		turn = !turn;
 	}
-	PossibleMove_free(move);
 	return 0;
 }
 
@@ -1223,9 +2282,9 @@ void modifyPieceOnSettingsBoard(SDL_Event e){
 	char modifiedPiece = Board_getPiece(copyOfMainBoard, modifiedTileX, modifiedTileY);
 
 	if (modifyingPiece != Board_EMPTY){ //adding a piece
-		short pieceColor = (toupper(modifyingPiece) == modifyingPiece)? BLACK : WHITE;
+		short pieceColor = Board_COLOR_OF(modifyingPiece);
 		if (PieceCounter_isAtMax(copyOfMainPieceCounter, modifyingPiece, modifiedTileX, modifiedTileY) || 
-			((toupper(modifyingPiece) == Board_BLACK_PAWN) &&
+			((Board_TYPE_OF(modifyingPiece) == Board_PAWN) &&
 			Board_isFurthestRowForPlayer(pieceColor, modifiedTileY))){
 			settingInvalidPiece = 1;
 		}
@@ -1247,24 +2306,69 @@ void modifyPieceOnSettingsBoard(SDL_Event e){
 	modifyingPiece = '_';
 }
 
+/*
+ * Waits for the next event, as SDL_WaitEvent does. 
+ * In single-threaded builds, the running search is stepped until an event comes.
+ * @return: 1 on success, 0 on error
+ */
+int waitForEvent(SDL_Event* e){
+#ifdef SINGLE_THREADED
+	while (backgroundSearchIsRunning() && !backgroundSearch.finished){
+		if (SDL_PollEvent(e)){
+			return 1;
+		}
+		stepBackgroundSearch();
+	}
+#endif
+	return SDL_WaitEvent(e);
+}
+
+/*
+ * The human turn procedure in GUI mode. Sleeps until an event arrives, handles it together with 
+ * any events that arrived meanwhile, and repaints only if one of them could have changed what is shown.
+ */
 int humanTurnGUI(int player){
 	Button* button;
 	Radio* radio;
+	// shows whatever changed before this turn, such as a new screen
+	if (GUI_paint()){
+		return 1;
+	}
 	while (turn == player){
 		SDL_Event e;
-		while (SDL_PollEvent(&e) != 0) {
+		if (!waitForEvent(&e)){
+			printf("ERROR: failed to wait for an event: %s\n", SDL_GetError());
+			return 1;
+		}
+		int changed = 0;
+		do {
+			// while the computer thinks, the board does not take moves
+			int computerIsThinking = backgroundSearchIsRunning() && backgroundSearch.kind == SEARCH_MOVE;
 			switch (e.type) {
 				case (SDL_QUIT):
+					cancelBackgroundSearch();
 					exit(0);
 				case (SDL_KEYUP):
+					changed = 1;
 					if (e.key.keysym.sym == SDLK_ESCAPE){
+						cancelBackgroundSearch();
 						exit(0);
 					}
+					if (e.key.keysym.sym == SDLK_m && state == GAME && !gameEnded && !computerIsThinking){
+						cancelBackgroundSearch();
+						return setSelectedMoveToMate();
+					}
 				case (SDL_MOUSEBUTTONUP):
+					changed = 1;
 					if (e.button.button == SDL_BUTTON_LEFT){
 						button = getButtonByMousePosition(e.button.x, e.button.y);
 						radio = getRadioByMousePosition(e.button.x, e.button.y);
 						if (button){
+							if (button->id == HINT && backgroundSearchIsRunning() && backgroundSearch.kind != SEARCH_PONDER){
+								break;
+							}
+							// new game, main menu, quit and every other button stop the search first
+							cancelBackgroundSearch();
 							return executeButton(button->id); 
 						}
 						else if (radio){
@@ -1273,7 +2377,8 @@ int humanTurnGUI(int player){
 						else if (modifyingPiece != '_' && copyOfMainBoard){
 							modifyPieceOnSettingsBoard(e);
 						}
-						else{
+						else if (!computerIsThinking){
+							cancelHint();
 							if(leftMouseButtonUp(e)){
 								return 1;
 							}
@@ -1281,7 +2386,8 @@ int humanTurnGUI(int player){
 					}
 
 					else if (e.button.button == SDL_BUTTON_RIGHT){
-						if (!chosePromotionMove){
+						if (!chosePromotionMove && !computerIsThinking){
+							cancelHint();
 							if(rightMouseButtonUp(e)){
 								return 1;
 							}
@@ -1290,6 +2396,7 @@ int humanTurnGUI(int player){
 					
 					break;
 				case (SDL_MOUSEMOTION):
+					changed = 1;
 					setAllButtonsToNormal();
 					button = getButtonByMousePosition(e.button.x, e.button.y);
 					if (button){
@@ -1297,20 +2404,30 @@ int humanTurnGUI(int player){
 					}	
 					break;
 				case (SDL_MOUSEBUTTONDOWN):
+					changed = 1;
 					setAllButtonsToNormal();
 					button = getButtonByMousePosition(e.button.x, e.button.y);
 					if (button){
 						Button_setToPressed(button);
 					}	
 					break;
+				case (SDL_VIDEOEXPOSE):
+					changed = 1;
+					GUI_invalidateAll();
+					break;
+				case (SDL_USEREVENT): // a timer or the computer woke the loop up
+					changed = 1;
+					if (e.user.code == GUI_AI_DONE_EVENT && finishBackgroundSearch()){
+						return 1;
+					}
+					break;
 				default:
 					break;
 			}
-		}
-		if (GUI_paint()){
+		} while (SDL_PollEvent(&e));
+		if (changed && GUI_paint()){
 			return 1;
 		}
-		SDL_Delay(10);
 	}
 	
 	return 0;
@@ -1333,10 +2450,11 @@ int humanTurn(int player){
 }
 
 int isEndGame(){
-	int canPlayerMove = Board_possibleMovesExist(&board, turn);
-	if (canPlayerMove == -1){
+	LegalMoves* legal = getLegalMoves();
+	if (!legal){
 		allocationFailed();
 	}
+	int canPlayerMove = legal->numOfMoves > 0;
 	
 	//losing scenario
 	if (Board_isInCheck(&board, turn)){
@@ -1373,9 +2491,23 @@ void printEndGameResults(){
 }
 
 int main(int argc, char* argv[]){
+	if (argc > 1 && str_equals(argv[1], "build_book")){
+		if (argc < 4){
+			printf("Usage: chessprog build_book <book file> <pgn files...>\n");
+			return 0;
+		}
+		Board_initAttackTables();
+		Board_initZobristKeys();
+		printError(Book_build(argv[2], argv+3, argc-3));
+		return 0;
+	}
+	if (argc > 1 && str_equals(argv[1], "build_bitbases")){
+		printError(Bitbase_build());
+		return 0;
+	}
 	displayMode = CONSOLE;
 	if(argc>1){
-		if (str_equals(argv[1], "gui")){
+		if (str_equals(argv[1], "gui") || str_equals(argv[1], "bench_board")){
 			displayMode = GUI;
 		}
 	}
@@ -1388,6 +2520,10 @@ int main(int argc, char* argv[]){
 		exit(0);
 	}
 	
+	if (argc > 1 && str_equals(argv[1], "bench_board")){
+		return GUI_benchmarkBoard();
+	}
+	
 	display();
 
 	while (1){
@@ -1399,7 +2535,8 @@ int main(int argc, char* argv[]){
 				gameEnded = 1;
 			}
 		}
-		if (turn != player1 && gameMode == SINGLE_PLAYER_MODE && !gameEnded){
+		// in GUI mode the computer only plays while the game is on screen
+		if (turn != player1 && gameMode == SINGLE_PLAYER_MODE && !gameEnded && (displayMode == CONSOLE || state == GAME)){
 			if (computerTurn()){
 				allocationFailed();
 			}
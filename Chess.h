@@ -4,10 +4,17 @@
 #include "PossibleMove.h"
 #include "Board.h"
 #include "PossibleMoveList.h"
+#include "MoveGenerator.h"
+#include "MateSolver.h"
+#include "Bitbase.h"
+#include "Book.h"
+#include "EvalCache.h"
+#include "Nnue.h"
 #include "PieceCounter.h"
 #include "Iterator.h"
 #include "LinkedList.h"
 #include "GUI.h"
+#include "SDL_thread.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -23,13 +30,18 @@
 #define GUI 1
 #define SINGLE_PLAYER_MODE 2
 #define TWO_PLAYERS_MODE 1
+#define MATE_HINT_MOVES 3
 
 #define str_equals(x, y) strcmp(x, y) == 0
-#define toBlack(x) toupper(x)
+#define toBlack(x) ((x) | Board_BLACK_FLAG)
 
 Board board;
 int displayMode;
 int maxRecursionDepth;
+int useNeuralNetwork;
+int usePondering;
+volatile int searchCancelled;
+int searchPlayer;
 int state;
 int gameMode;
 int player1;
@@ -51,4 +63,6 @@ int lastDestinationTileY;
 
 int pieceIsPawn(int x, int y);
 
+int humanTurnGUI(int player);
+
 #endif
\ No newline at end of file
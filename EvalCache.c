@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include "EvalCache.h"
+
+/*
+ * The score of the position with the given key, with (nextPlayer) to move,
+ * according to the scoring function numbered (function).
+ */
+typedef struct EvalCacheEntry{
+	uint64_t key;
+	int whiteScore;
+	char nextPlayer;
+	char function;
+} EvalCacheEntry;
+
+static EvalCacheEntry* entries = NULL;
+static int mask = 0;
+static long hits = 0;
+static long misses = 0;
+
+/*
+ * Replaces the cache by an empty one of (numOfEntries) entries, rounded down to a power of two.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+int EvalCache_setSize(int numOfEntries){
+	int size = 1;
+	while (size <= numOfEntries/2){
+		size *= 2;
+	}
+	EvalCacheEntry* resized = (EvalCacheEntry*)calloc(size, sizeof(EvalCacheEntry));
+	if (!resized){
+		return -1;
+	}
+	for (int i = 0; i < size; i++){
+		resized[i].function = -1; // no entry
+	}
+	free(entries);
+	entries = resized;
+	mask = size - 1;
+	return 0;
+}
+
+/*
+ * Looks up the score of (board) with (nextPlayer) to move.
+ *
+ * @params: (whiteScore) - set to the score, from white's point of view, if it is found
+ * @return: 1 if the score was found, 0 otherwise
+ */
+int EvalCache_probe(Board* board, int nextPlayer, int function, int* whiteScore){
+	EvalCacheEntry* entry = &entries[board->key & mask];
+	if (entry->key != board->key || entry->nextPlayer != nextPlayer || entry->function != function){
+		misses++;
+		return 0;
+	}
+	hits++;
+	*whiteScore = entry->whiteScore;
+	return 1;
+}
+
+void EvalCache_store(Board* board, int nextPlayer, int function, int whiteScore){
+	EvalCacheEntry* entry = &entries[board->key & mask];
+	entry->key = board->key;
+	entry->whiteScore = whiteScore;
+	entry->nextPlayer = nextPlayer;
+	entry->function = function;
+}
+
+/*
+ * @params: (hitCount), (missCount) - set to the number of lookups that found their score and that did not
+ */
+void EvalCache_getStats(long* hitCount, long* missCount){
+	*hitCount = hits;
+	*missCount = misses;
+}
@@ -0,0 +1,22 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "Board.h"
+
+/*
+ * Remembers the scores the scoring functions gave to recently evaluated positions,
+ * one position per slot, indexed by the low bits of the position's key.
+ * Scores are kept from white's point of view, since the scoring functions are symmetric.
+ */
+#define EvalCache_DEFAULT_SIZE (1 << 16)
+#define EvalCache_MAX_SIZE     (1 << 26)
+
+int EvalCache_setSize(int numOfEntries);
+
+int EvalCache_probe(Board* board, int nextPlayer, int function, int* whiteScore);
+
+void EvalCache_store(Board* board, int nextPlayer, int function, int whiteScore);
+
+void EvalCache_getStats(long* hitCount, long* missCount);
+
+#endif
@@ -2,38 +2,173 @@
 
 Window* window;
 
+/*
+ * The rectangle of each piece's sprite in the atlas Textures/pieces.bmp, indexed by piece code.
+ */
+#define SPRITE(column, row) {(column)*TILE_SIZE, (row)*TILE_SIZE, TILE_SIZE, TILE_SIZE}
+static const SDL_Rect pieceSprites[16] = {
+	SPRITE(0, 0), SPRITE(2, 1), SPRITE(0, 1), SPRITE(2, 2), SPRITE(0, 2), SPRITE(2, 0), SPRITE(0, 0), SPRITE(0, 0),
+	SPRITE(0, 0), SPRITE(3, 1), SPRITE(1, 1), SPRITE(3, 2), SPRITE(1, 2), SPRITE(3, 0), SPRITE(1, 0), SPRITE(0, 0)
+};
+
 //general functions
 
 /*
- * Sets the correct color key for (img).
- * @return: 1 if any failures occured, 0 otherwise
+ * Every image the GUI draws, by number. Each is loaded from disk once, by GUI_init, 
+ * and the same surface is drawn from then on, so nothing is read from disk while painting.
+ * Drawing functions refer to the images by number, so that getting one is a single array access.
  */
-static int setBlueToTransparent(SDL_Surface* img){
-	if (SDL_SetColorKey(img, SDL_SRCCOLORKEY, SDL_MapRGB(img->format, 127, 127, 255))) {
-		printf("ERROR: failed to set color key: %s\n", SDL_GetError());
-		SDL_FreeSurface(img);
-		return 1;
-	}
-	return 0;
-}
+#define TEXTURE_AI_COLOR_HEADER 0
+#define TEXTURE_AI_SETTINGS_HEADER 1
+#define TEXTURE_BLACK_PROMOTION_BUTTONS 2
+#define TEXTURE_BOARD_SETTINGS_HEADER 3
+#define TEXTURE_BOARD_SETTINGS_INSTRUCTIONS 4
+#define TEXTURE_BOARD_LETTERS 5
+#define TEXTURE_BOARD_NUMBERS 6
+#define TEXTURE_CHECK 7
+#define TEXTURE_DEPTH_FOR_HINTS_HEADER 8
+#define TEXTURE_DIFFICULTY_HEADER 9
+#define TEXTURE_DIFFICULTY_LABELS 10
+#define TEXTURE_GAME_BUTTONS 11
+#define TEXTURE_GAME_MODE_HEADER 12
+#define TEXTURE_GAME_MODE_LABELS 13
+#define TEXTURE_INSTRUCTIONS 14
+#define TEXTURE_INSTRUCTIONS_BUTTON 15
+#define TEXTURE_KING_MISSING_ERROR 16
+#define TEXTURE_MAIN_BUTTONS 17
+#define TEXTURE_MAIN 18
+#define TEXTURE_MAKE_YOUR_MOVE 19
+#define TEXTURE_MATE 20
+#define TEXTURE_NEXT_PLAYER_HEADER 21
+#define TEXTURE_NEXT_PLAYER_LABELS 22
+#define TEXTURE_NO_SAVE_SLOTS 23
+#define TEXTURE_PIECES 24
+#define TEXTURE_PIECES_BUTTONS 25
+#define TEXTURE_PLAYER_SETTINGS_HEADER 26
+#define TEXTURE_PLAYER_SETTINGS_ICON 27
+#define TEXTURE_RADIO 28
+#define TEXTURE_SAVE_LOAD 29
+#define TEXTURE_SAVE_SLOTS 30
+#define TEXTURE_SETTING_PIECE_ERROR 31
+#define TEXTURE_TIE 32
+#define TEXTURE_WHITE_PROMOTION_BUTTONS 33
+
+static const char* texturePaths[] = {
+	[TEXTURE_AI_COLOR_HEADER] = "Textures/AIColorHeader.bmp",
+	[TEXTURE_AI_SETTINGS_HEADER] = "Textures/AISettingsHeader.bmp",
+	[TEXTURE_BLACK_PROMOTION_BUTTONS] = "Textures/blackPromotionButtons.bmp",
+	[TEXTURE_BOARD_SETTINGS_HEADER] = "Textures/boardSettingsHeader.bmp",
+	[TEXTURE_BOARD_SETTINGS_INSTRUCTIONS] = "Textures/boardSettingsInstructions.bmp",
+	[TEXTURE_BOARD_LETTERS] = "Textures/board_letters.bmp",
+	[TEXTURE_BOARD_NUMBERS] = "Textures/board_numbers.bmp",
+	[TEXTURE_CHECK] = "Textures/check.bmp",
+	[TEXTURE_DEPTH_FOR_HINTS_HEADER] = "Textures/depthForHintsHeader.bmp",
+	[TEXTURE_DIFFICULTY_HEADER] = "Textures/difficultyHeader.bmp",
+	[TEXTURE_DIFFICULTY_LABELS] = "Textures/difficultyLabels.bmp",
+	[TEXTURE_GAME_BUTTONS] = "Textures/gameButtons.bmp",
+	[TEXTURE_GAME_MODE_HEADER] = "Textures/gameModeHeader.bmp",
+	[TEXTURE_GAME_MODE_LABELS] = "Textures/gameModeLabels.bmp",
+	[TEXTURE_INSTRUCTIONS] = "Textures/instructions.bmp",
+	[TEXTURE_INSTRUCTIONS_BUTTON] = "Textures/instructionsButton.bmp",
+	[TEXTURE_KING_MISSING_ERROR] = "Textures/kingMissingError.bmp",
+	[TEXTURE_MAIN_BUTTONS] = "Textures/main buttons.bmp",
+	[TEXTURE_MAIN] = "Textures/main.bmp",
+	[TEXTURE_MAKE_YOUR_MOVE] = "Textures/makeYourMove.bmp",
+	[TEXTURE_MATE] = "Textures/mate.bmp",
+	[TEXTURE_NEXT_PLAYER_HEADER] = "Textures/nextPlayerHeader.bmp",
+	[TEXTURE_NEXT_PLAYER_LABELS] = "Textures/nextPlayerLabels.bmp",
+	[TEXTURE_NO_SAVE_SLOTS] = "Textures/noSaveSlots.bmp",
+	[TEXTURE_PIECES] = "Textures/pieces.bmp",
+	[TEXTURE_PIECES_BUTTONS] = "Textures/piecesButtons.bmp",
+	[TEXTURE_PLAYER_SETTINGS_HEADER] = "Textures/playerSettingsHeader.bmp",
+	[TEXTURE_PLAYER_SETTINGS_ICON] = "Textures/playerSettingsIcon.bmp",
+	[TEXTURE_RADIO] = "Textures/radio.bmp",
+	[TEXTURE_SAVE_LOAD] = "Textures/saveLoad.bmp",
+	[TEXTURE_SAVE_SLOTS] = "Textures/saveSlots.bmp",
+	[TEXTURE_SETTING_PIECE_ERROR] = "Textures/settingPieceError.bmp",
+	[TEXTURE_TIE] = "Textures/tie.bmp",
+	[TEXTURE_WHITE_PROMOTION_BUTTONS] = "Textures/whitePromotionButtons.bmp"
+};
+
+#define NUM_OF_TEXTURES (int)(sizeof(texturePaths)/sizeof(texturePaths[0]))
+
+static SDL_Surface* textures[NUM_OF_TEXTURES];
 
 /*
- * Loads a BMP image file into an SDL_Surface structure and return the structure.
+ * Loads a BMP image file, converts it to the pixel format of the display, 
+ * so that drawing it needs no conversion, and sets the correct color key for it.
  * @params: (path) - the relative path of the BMP file to be loaded
  * @return: NULL if any failures occured, the SDL_Surface structure containing the image otherwise 
  */
-static SDL_Surface* loadImage(const char* path){
-	SDL_Surface* img = SDL_LoadBMP(path);
-	if (!img){
+static SDL_Surface* loadTexture(const char* path){
+	SDL_Surface* loaded = SDL_LoadBMP(path);
+	if (!loaded){
 		printf("ERROR: failed to load BMP file: %s\n", SDL_GetError());
 		return NULL;
 	}
-	if (setBlueToTransparent(img)){
+	SDL_Surface* img = SDL_DisplayFormat(loaded);
+	if (img != loaded){
+		SDL_FreeSurface(loaded);
+	}
+	if (!img){
+		printf("ERROR: failed to convert BMP file: %s\n", SDL_GetError());
+		return NULL;
+	}
+	// run-length encoded, the transparent pixels are skipped rather than tested when drawing
+	if (SDL_SetColorKey(img, SDL_SRCCOLORKEY | SDL_RLEACCEL, SDL_MapRGB(img->format, 127, 127, 255))) {
+		printf("ERROR: failed to set color key: %s\n", SDL_GetError());
+		SDL_FreeSurface(img);
 		return NULL;
 	}
 	return img;
 }
 
+/*
+ * Loads all textures. Must be called after the video mode is set.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+static int loadTextures(){
+	for (int i = 0; i < NUM_OF_TEXTURES; i++){
+		textures[i] = loadTexture(texturePaths[i]);
+		if (!textures[i]){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void freeTextures(){
+	for (int i = 0; i < NUM_OF_TEXTURES; i++){
+		if (textures[i]){
+			SDL_FreeSurface(textures[i]);
+			textures[i] = NULL;
+		}
+	}
+}
+
+/*
+ * @params: (texture) - the number of the image, one of the TEXTURE_ constants
+ * @return: the loaded image. It must not be freed. 
+ */
+static SDL_Surface* getTexture(int texture){
+	return textures[texture];
+}
+
+/*
+ * Finds an image by the path it was loaded from. Meant for creating buttons and labels, not for drawing.
+ * @params: (path) - the relative path of the BMP file the image was loaded from
+ * @return: NULL if no such image was loaded, the loaded image otherwise. It must not be freed. 
+ */
+static SDL_Surface* findTexture(const char* path){
+	for (int i = 0; i < NUM_OF_TEXTURES; i++){
+		if (textures[i] && strcmp(texturePaths[i], path) == 0){
+			return textures[i];
+		}
+	}
+	printf("ERROR: texture was not loaded: %s\n", path);
+	return NULL;
+}
+
 /*
  * Draws the surface (img) on the surface (surface), 
  * (x,y) being the coordinates on (surface) where the top left corner of (img) will be.
@@ -49,21 +184,14 @@ static int drawImage(SDL_Surface* img, SDL_Surface* surface, int x, int y){
 }
 
 /*
- * Draws the image stored on a BMP file located at (path) on (surface),
- * (x,y) being the coordinates on (surface) where the top left corner of (img) will be. 
+ * Draws the image numbered (texture) on (surface),
+ * (x,y) being the coordinates on (surface) where the top left corner of the image will be. 
  * @return: 1 if any failures occured, 0 otherwise
  */
-static int drawImageByPath(const char* path, SDL_Surface* surface, int x, int y){
-	SDL_Surface* img = loadImage(path);
-	if (!img){
-		SDL_FreeSurface(img);
-		return 1;
-	}	
-	if(drawImage(img, surface, x, y)){
-		SDL_FreeSurface(img);
+static int drawTexture(int texture, SDL_Surface* surface, int x, int y){
+	if(drawImage(getTexture(texture), surface, x, y)){
 		return 1;
 	}
-	SDL_FreeSurface(img);
 	return 0;
 }
 
@@ -81,24 +209,20 @@ static int drawSubImage(SDL_Surface* img, SDL_Rect crop, SDL_Surface* surface, S
 }
 
 /*
- * Fills (panel) with our chosen background color.
- * @return: 1 if any failures occured, 0 otherwise
+ * @params: (color) - a color given as 0xRRGGBB
+ * @return: (color) in the pixel format of (surface), which is the display's and not necessarily 32-bit RGB
  */
-static int fillBackground(Panel* panel){
-	if (SDL_FillRect(panel->surface, 0, BACKGROUND_WHITE) != 0) {
-		printf("ERROR: failed to draw rect: %s\n", SDL_GetError());
-		return 1;
-	}
-	return 0;
+static Uint32 mapColor(SDL_Surface* surface, Uint32 color){
+	return SDL_MapRGB(surface->format, (color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff);
 }
 
 /*
- * Flips the buffer belonging to (surface).
+ * Fills (panel) with our chosen background color.
  * @return: 1 if any failures occured, 0 otherwise
  */
-static int flipBuffer(SDL_Surface* surface){
-	if (SDL_Flip(surface)) {
-		printf("ERROR: failed to flip buffer: %s\n", SDL_GetError());
+static int fillBackground(Panel* panel){
+	if (SDL_FillRect(panel->surface, 0, mapColor(panel->surface, BACKGROUND_WHITE)) != 0) {
+		printf("ERROR: failed to draw rect: %s\n", SDL_GetError());
 		return 1;
 	}
 	return 0;
@@ -125,6 +249,54 @@ static SDL_Rect findAbsoluteRectPosition(SDL_Rect rect, Panel* parent){
 	return Rect_new(panelX+rectX, panelY+rectY, rect.w, rect.h);
 }
 
+//dirty region functions
+
+/*
+ * The regions of the window that changed since it was last presented, in window coordinates.
+ * GUI_paint redraws and presents only these, and nothing at all when none changed.
+ */
+#define MAX_DIRTY_RECTS 64
+
+static SDL_Rect dirtyRects[MAX_DIRTY_RECTS];
+static int numOfDirtyRects = 0;
+static int wholeWindowIsDirty = 0;
+
+/*
+ * Marks the whole window as changed.
+ */
+void GUI_invalidateAll(){
+	dirtyRects[0] = Rect_new(0, 0, window->surface->w, window->surface->h);
+	numOfDirtyRects = 1;
+	wholeWindowIsDirty = 1;
+}
+
+/*
+ * Marks (rect), given in window coordinates, as changed. 
+ * Once there are too many changed regions the whole window is marked instead.
+ */
+static void invalidate(SDL_Rect rect){
+	if (wholeWindowIsDirty){
+		return;
+	}
+	if (numOfDirtyRects == MAX_DIRTY_RECTS){
+		GUI_invalidateAll();
+		return;
+	}
+	// presented regions must lie within the window
+	int left = (rect.x > 0)? rect.x: 0;
+	int top = (rect.y > 0)? rect.y: 0;
+	int right = (rect.x + rect.w < window->surface->w)? rect.x + rect.w: window->surface->w;
+	int bottom = (rect.y + rect.h < window->surface->h)? rect.y + rect.h: window->surface->h;
+	if (left >= right || top >= bottom){
+		return;
+	}
+	dirtyRects[numOfDirtyRects++] = Rect_new(left, top, right-left, bottom-top);
+}
+
+static int Rect_intersects(SDL_Rect a, SDL_Rect b){
+	return a.x < b.x+b.w && b.x < a.x+a.w && a.y < b.y+b.h && b.y < a.y+a.h;
+}
+
 //Label functions
 
 /*
@@ -143,7 +315,7 @@ Label* Label_new(const char* path, SDL_Surface* parent, SDL_Rect crop, SDL_Rect
 	}
 	label->crop = crop;
 	label->pos = pos;
-	label->image = loadImage(path);
+	label->image = findTexture(path);
 	if (!label->image){
 		free(label);
 		return NULL;
@@ -168,7 +340,6 @@ int Label_draw(void* data){
  */
 void Label_free(void* data){
 	Label* label = (Label*)data;
-	SDL_FreeSurface(label->image);
 	free(label);
 }
 
@@ -190,7 +361,7 @@ static Button* Button_new(int id, Panel* parent, SDL_Rect rect, int y, const cha
 		return NULL;
 	}
 		
-	button->img = loadImage(path);
+	button->img = findTexture(path);
 	if (!button->img){
 		free(button);
 		return NULL;
@@ -213,28 +384,41 @@ static Button* Button_new(int id, Panel* parent, SDL_Rect rect, int y, const cha
 	return button;
 }
 
+/*
+ * Sets the image (button) displays to (current), marking the button as changed if it is a different one.
+ */
+static void Button_setCurrent(Button* button, SDL_Rect current){
+	if (button->current.x != current.x || button->current.y != current.y){
+		invalidate(button->absoluteRect);
+	}
+	button->current = current;
+}
+
 /*
  * Sets a button dislpayed image to the normal one (not pressed or hovered).
  */
 void Button_setToNormal(Button* button){
-	button->current = button->normal;
+	Button_setCurrent(button, button->normal);
 }
 
 /*
  * Sets a button dislpayed image to the hovered one.
  */
 void Button_setToHovered(Button* button){
-	button->current = button->hovered;
+	Button_setCurrent(button, button->hovered);
 }
 
 /*
  * Sets a button dislpayed image to the pressed one.
  */
 void Button_setToPressed(Button* button){
-	button->current = button->pressed;
+	Button_setCurrent(button, button->pressed);
 }
 
 void Button_hide(Button* button){
+	if (!button->hidden){
+		invalidate(button->absoluteRect);
+	}
 	button->hidden = 1;
 }
 
@@ -251,7 +435,6 @@ static int Button_draw(void* data){
 
 static void Button_free(void* data){
 	Button* button = (Button*) data;
-	SDL_FreeSurface(button->img);
 	free(button);
 }
 
@@ -280,17 +463,15 @@ Radio* Radio_new(const char* path, Panel* parent, SDL_Rect crop, SDL_Rect pos, i
 }
 
 int Radio_draw(Radio* radio){
-	SDL_Surface* radioImg = loadImage("Textures/radio.bmp");
+	SDL_Surface* radioImg = getTexture(TEXTURE_RADIO);
 	if (!radioImg){
 		return 1;
 	}
 	SDL_Rect radioImgPos = {radio->label->pos.x-24, radio->label->pos.y, 24, 24};
 	SDL_Rect radioImgCrop = {0, radio->state*24, 24, 24};
 	if (drawSubImage(radioImg, radioImgCrop, radio->label->parent, radioImgPos)){
-		SDL_FreeSurface(radioImg);
 		return 1;
 	}
-	SDL_FreeSurface(radioImg);
 	if (Label_draw(radio->label)){
 		return 1;
 	}
@@ -303,6 +484,8 @@ void Radio_select(Radio* radio, int state){
 	while(Iterator_hasNext(&iterator)){
 		Radio* current = (Radio*)Iterator_next(&iterator);
 		current->state = 0;
+		SDL_Rect pos = current->absolutePos;
+		invalidate(Rect_new(pos.x-24, pos.y, pos.w+24, pos.h));
 	}
 	radio->state = 1;
 	radio->group->selected = radio;
@@ -380,16 +563,34 @@ void RadioGroup_free(void* data){
 
 //Panel functions
 
+/*
+ * Creates a new Panel structure, covering the region (rect) of (parent).
+ * The panel has no pixels of its own: its surface is a view of that region of (parent)'s pixels,
+ * so whatever the panel draws lands straight in the window's back buffer, clipped to the panel.
+ * @return: a pointer to the new panel, NULL otherwise
+ */
 static Panel* Panel_new(SDL_Surface* parent, SDL_Rect rect, int(*drawFunc)(Panel*)){
+	if (rect.x < 0 || rect.y < 0 || rect.x + rect.w > parent->w || rect.y + rect.h > parent->h){
+		printf("ERROR: panel does not fit in its parent\n");
+		return NULL;
+	}
 	Panel* panel = (Panel*)malloc(sizeof(Panel));
 	if (!panel){
 		return NULL;
 	}
-	panel->surface = SDL_CreateRGBSurface(SDL_HWSURFACE, (&rect)->w, (&rect)->h, 32, 0, 0, 0, 0);
+	SDL_PixelFormat* format = parent->format;
+	Uint8* pixels = (Uint8*)parent->pixels + rect.y*parent->pitch + rect.x*format->BytesPerPixel;
+	panel->surface = SDL_CreateRGBSurfaceFrom(pixels, rect.w, rect.h, format->BitsPerPixel, parent->pitch, 
+			format->Rmask, format->Gmask, format->Bmask, format->Amask);
 	if (!panel->surface){
+		printf("ERROR: failed to create panel surface: %s\n", SDL_GetError());
 		free(panel);
 		return NULL;
 	}
+	// colors must map the same way they do in the window
+	if (format->palette){
+		SDL_SetColors(panel->surface, format->palette->colors, 0, format->palette->ncolors);
+	}
 	panel->rect = rect;
 	panel->parent = parent;	
 	panel->drawFunc = drawFunc;
@@ -398,16 +599,9 @@ static Panel* Panel_new(SDL_Surface* parent, SDL_Rect rect, int(*drawFunc)(Panel
 	return panel;
 }
 
-static int Panel_flipAndDraw(Panel* panel){
-	if (flipBuffer(panel->surface)) {
-		return 1;
-	}
-	if (drawImage(panel->surface, panel->parent, panel->rect.x, panel->rect.y)) {
-		return 1;
-	}
-	return 0;
-}
-
+/*
+ * Frees a panel structure. The pixels it draws on belong to its parent and are not freed.
+ */
 static void Panel_free(void* data){
 	Panel* panel = (Panel*)data;
 	SDL_FreeSurface(panel->surface);
@@ -418,7 +612,7 @@ static void Panel_free(void* data){
 }
 
 static int MainMenu_draw(Panel* panel){
-	drawImageByPath("Textures/main.bmp", panel->surface, 0, 0);
+	drawTexture(TEXTURE_MAIN, panel->surface, 0, 0);
 	
 	Iterator iterator;
 	Iterator_init(&iterator, panel->children);
@@ -427,61 +621,70 @@ static int MainMenu_draw(Panel* panel){
 			return 1;
 		}
 	}
-	
-	if (Panel_flipAndDraw(panel)){
-		return 1;
-	}
 	return 0;
 }
 
-static int drawBoard(Panel* panel, Board* board){
-	SDL_Surface* img = loadImage("Textures/pieces.bmp");
-	if (!img){
-		SDL_FreeSurface(img);
+/*
+ * The checkered tiles of the board, painted once by createBoardBackground.
+ */
+static SDL_Surface* boardBackground = NULL;
+
+/*
+ * Paints the tiles of the board on a surface of the display's pixel format, 
+ * so that drawing them all takes a single blit.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+static int createBoardBackground(){
+	SDL_PixelFormat* format = window->surface->format;
+	boardBackground = SDL_CreateRGBSurface(SDL_SWSURFACE, 8*TILE_SIZE, 8*TILE_SIZE, format->BitsPerPixel, 
+			format->Rmask, format->Gmask, format->Bmask, format->Amask);
+	if (!boardBackground){
+		printf("ERROR: failed to create board background: %s\n", SDL_GetError());
 		return 1;
 	}
-	
 	for (int x = 1; x <= 8; x++){
 		for (int y = 1; y <= 8; y++){
-			SDL_Rect crop = {0, 0, TILE_SIZE, TILE_SIZE};
-			SDL_Rect piecePosition = {(x-1)*TILE_SIZE, (8-y)*TILE_SIZE, TILE_SIZE, TILE_SIZE};
-			
+			SDL_Rect tile = {(x-1)*TILE_SIZE, (8-y)*TILE_SIZE, TILE_SIZE, TILE_SIZE};
 			int isBlackSquare = ((x+y) % 2 == 0);
-			if (SDL_FillRect(panel->surface, &piecePosition, isBlackSquare? BLACK_TILE_COLOR : WHITE_TILE_COLOR) != 0){
+			if (SDL_FillRect(boardBackground, &tile, mapColor(boardBackground, isBlackSquare? BLACK_TILE_COLOR : WHITE_TILE_COLOR)) != 0){
 				printf("ERROR: failed to draw rect: %s\n", SDL_GetError());
-				SDL_FreeSurface(img);
-				return 1;
-			}
-			char piece = Board_getPiece(board, x, y);
-			
-			switch (piece) {
-				case (Board_EMPTY): continue;
-				case (Board_WHITE_KING): break;
-				case (Board_BLACK_KING):   crop.x = 1*TILE_SIZE; break;
-				case (Board_WHITE_QUEEN):  crop.x = 2*TILE_SIZE; break;
-				case (Board_BLACK_QUEEN):  crop.x = 3*TILE_SIZE; break;
-				case (Board_WHITE_ROOK):   crop.y = 2*TILE_SIZE; break;
-				case (Board_BLACK_ROOK):   crop.x = 1*TILE_SIZE; crop.y = 2*TILE_SIZE; break;
-				case (Board_WHITE_KNIGHT): crop.y = 1*TILE_SIZE; break;
-				case (Board_BLACK_KNIGHT): crop.x = 1*TILE_SIZE; crop.y = 1*TILE_SIZE; break;
-				case (Board_WHITE_BISHOP): crop.x = 2*TILE_SIZE; crop.y = 2*TILE_SIZE; break;
-				case (Board_BLACK_BISHOP): crop.x = 3*TILE_SIZE; crop.y = 2*TILE_SIZE; break;
-				case (Board_WHITE_PAWN):   crop.x = 2*TILE_SIZE; crop.y = 1*TILE_SIZE; break;
-				case (Board_BLACK_PAWN):   crop.x = 3*TILE_SIZE; crop.y = 1*TILE_SIZE; break;
-			}
-
-			if (drawSubImage(img, crop, panel->surface, piecePosition)){
-				SDL_FreeSurface(img);
 				return 1;
 			}
 		}
 	}
-	if (Panel_flipAndDraw(panel)){
-		SDL_FreeSurface(img);
+	return 0;
+}
+
+/*
+ * Draws the tiles and then the pieces of (board), skipping the pieces outside the region being painted.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+static int drawBoard(Panel* panel, Board* board){
+	SDL_Surface* img = getTexture(TEXTURE_PIECES);
+	if (!img){
+		return 1;
+	}
+	if (drawImage(boardBackground, panel->surface, 0, 0)){
 		return 1;
 	}
 	
-	SDL_FreeSurface(img);
+	SDL_Rect clip;
+	SDL_GetClipRect(panel->surface, &clip);
+	uint64_t pieces = board->occupied[WHITE] | board->occupied[BLACK];
+	while (pieces){
+		int square = __builtin_ctzll(pieces);
+		pieces &= pieces - 1;
+		int x = Board_FILE(square);
+		int y = Board_RANK(square);
+		SDL_Rect piecePosition = {(x-1)*TILE_SIZE, (8-y)*TILE_SIZE, TILE_SIZE, TILE_SIZE};
+		if (!Rect_intersects(piecePosition, clip)){
+			continue;
+		}
+		SDL_Rect crop = pieceSprites[(int)Board_getPiece(board, x, y)];
+		if (drawSubImage(img, crop, panel->surface, piecePosition)){
+			return 1;
+		}
+	}
 	
 	return 0;
 }
@@ -499,10 +702,6 @@ static int piecesPanel_draw(Panel* panel){
 		}
 	}
 	
-	if (Panel_flipAndDraw(panel)){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -514,10 +713,6 @@ static int settingsBoardPanel_draw(Panel* panel){
 	if (drawBoard(panel, copyOfMainBoard)){
 		return 1;
 	}
-		
-	if (Panel_flipAndDraw(panel)){
-		return 1;
-	}
 	
 	return 0;
 	
@@ -528,47 +723,61 @@ static int boardSettingsHeaderPanel_draw(Panel* panel){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/boardSettingsHeader.bmp", panel->surface, 4.2*TILE_SIZE, 0.2*TILE_SIZE)){
+	if (drawTexture(TEXTURE_BOARD_SETTINGS_HEADER, panel->surface, 4.2*TILE_SIZE, 0.2*TILE_SIZE)){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/board_letters.bmp", panel->surface, 2*TILE_SIZE, 1.45*TILE_SIZE) != 0){
+	if (drawTexture(TEXTURE_BOARD_LETTERS, panel->surface, 2*TILE_SIZE, 1.45*TILE_SIZE) != 0){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/boardSettingsInstructions.bmp", panel->surface, 1.2*TILE_SIZE ,0.7*TILE_SIZE)){
+	if (drawTexture(TEXTURE_BOARD_SETTINGS_INSTRUCTIONS, panel->surface, 1.2*TILE_SIZE ,0.7*TILE_SIZE)){
 		return 1;
 	}
 	
 	if (settingInvalidPiece){
-		if (drawImageByPath("Textures/settingPieceError.bmp", panel->surface, 1.7*TILE_SIZE, 1.2*TILE_SIZE)){
+		if (drawTexture(TEXTURE_SETTING_PIECE_ERROR, panel->surface, 1.7*TILE_SIZE, 1.2*TILE_SIZE)){
 			return 1;
 		}
 	}
 	
 	if (kingIsMissing){
-		if (drawImageByPath("Textures/kingMissingError.bmp", panel->surface, 3.2*TILE_SIZE, 1.2*TILE_SIZE)){
+		if (drawTexture(TEXTURE_KING_MISSING_ERROR, panel->surface, 3.2*TILE_SIZE, 1.2*TILE_SIZE)){
 			return 1;
 		}
 	}
 	
-	if (Panel_flipAndDraw(panel)){
-		return 1;
-	}
-	
 	return 0;
 	
 }
 
+/*
+ * Finds the tile highlighted for a move of the selected piece.
+ * @params: (x,y) - set to the coordinates of the tile
+ */
+static void getHighlightedTile(PossibleMove* move, int* x, int* y){
+	*x = move->toX;
+	*y = move->toY;
+	//castle, rook is selected
+	if (move->toX == 0){
+		int player = Board_getColor(&board, selectedX, selectedY);
+		*x = Board_FILE(board.kingSquare[player]);
+		*y = Board_RANK(board.kingSquare[player]);
+	}
+	//castle, king is selected
+	if (move->fromX != selectedX || move->fromY != selectedY){ 
+		*x = move->fromX;
+		*y = move->fromY;
+	}
+}
+
 static int gameBoardPanel_draw(Panel* panel){
-	SDL_Surface* img = loadImage("Textures/pieces.bmp");
+	SDL_Surface* img = getTexture(TEXTURE_PIECES);
 	if (!img){
-		SDL_FreeSurface(img);
 		return 1;
 	}
 	
 	if(drawBoard(panel, &board)){
-		SDL_FreeSurface(img);
 		return 1;
 	}
 	
@@ -577,7 +786,6 @@ static int gameBoardPanel_draw(Panel* panel){
 		SDL_Rect fromRect = {(selectedX-1)*TILE_SIZE, (8-selectedY)*TILE_SIZE, TILE_SIZE, TILE_SIZE};
 		SDL_Rect selected = {0, 3*TILE_SIZE, TILE_SIZE, TILE_SIZE};
 		if (drawSubImage(img, selected, panel->surface, fromRect)){
-			SDL_FreeSurface(img);
 			return 1;
 		}
 	}	
@@ -587,32 +795,16 @@ static int gameBoardPanel_draw(Panel* panel){
 		SDL_Rect dest = {TILE_SIZE, 3*TILE_SIZE, TILE_SIZE, TILE_SIZE};
 		while (Iterator_hasNext(&iterator)){
 			PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
-			SDL_Rect toRect = {((move->toX)-1)*TILE_SIZE, (8-move->toY)*TILE_SIZE, TILE_SIZE, TILE_SIZE};			
-			//castle, rook is selected
-			if (move->toX == 0){
-				int player = Board_getColor(&board, selectedX, selectedY);
-				toRect.x = ((board.kingX[player])-1)*TILE_SIZE;
-				toRect.y = (8-board.kingY[player])*TILE_SIZE;
-			}
-			//castle, king is selected
-			if (move->fromX != selectedX || move->fromY != selectedY){ 
-				toRect.x = ((move->fromX)-1)*TILE_SIZE;
-				toRect.y = (8-move->fromY)*TILE_SIZE;
-			}
+			int x, y;
+			getHighlightedTile(move, &x, &y);
+			SDL_Rect toRect = {(x-1)*TILE_SIZE, (8-y)*TILE_SIZE, TILE_SIZE, TILE_SIZE};
 			
 			if (drawSubImage(img, dest, panel->surface, toRect)){
-				SDL_FreeSurface(img);
 				return 1;
 			}
 		}
 	}
 	
-	if (Panel_flipAndDraw(panel)){
-		SDL_FreeSurface(img);
-		return 1;
-	}
-	SDL_FreeSurface(img);
-	
 	return 0;
 }
 
@@ -621,7 +813,7 @@ static int announcementsPanel_draw(Panel* panel){
 		return 1;
 	}
 
-	if (drawImageByPath("Textures/board_letters.bmp", panel->surface, 2*TILE_SIZE, 0) != 0){
+	if (drawTexture(TEXTURE_BOARD_LETTERS, panel->surface, 2*TILE_SIZE, 0) != 0){
 		return 1;
 	}
 	
@@ -634,14 +826,14 @@ static int announcementsPanel_draw(Panel* panel){
 	}
 		
 	if (isInCheck && !gameEnded){
-		if (drawImageByPath("Textures/check.bmp", panel->surface, 5.2*TILE_SIZE, 0.5*TILE_SIZE) != 0){
+		if (drawTexture(TEXTURE_CHECK, panel->surface, 5.2*TILE_SIZE, 0.5*TILE_SIZE) != 0){
 			return 1;
 		}
 	}
 	
 	if(gameEnded){
 		if(isInCheck){
-			SDL_Surface* mate = loadImage("Textures/mate.bmp");
+			SDL_Surface* mate = getTexture(TEXTURE_MATE);
 			if(!mate){
 				return 1;
 			}
@@ -651,22 +843,19 @@ static int announcementsPanel_draw(Panel* panel){
 			SDL_Rect pos = {3*TILE_SIZE, TILE_SIZE, mate->w, 0.5*(mate->h)};
 			
 			if (drawSubImage(mate, crop, panel->surface, pos) != 0){
-				SDL_FreeSurface(mate);
 				return 1;
 			}
-			
-			SDL_FreeSurface(mate);
 		}
 		
 		else{
-			if(drawImageByPath("Textures/tie.bmp", panel->surface, 3*TILE_SIZE, TILE_SIZE) != 0){
+			if(drawTexture(TEXTURE_TIE, panel->surface, 3*TILE_SIZE, TILE_SIZE) != 0){
 				return 1;
 			}
 		}
 	}
 	
 	else{
-		SDL_Surface* makeYourMove = loadImage("Textures/makeYourMove.bmp");
+		SDL_Surface* makeYourMove = getTexture(TEXTURE_MAKE_YOUR_MOVE);
 		if (!makeYourMove){
 			return 1;
 		}
@@ -687,15 +876,8 @@ static int announcementsPanel_draw(Panel* panel){
 		SDL_Rect pos = {3*TILE_SIZE, TILE_SIZE, 375, 30};
 		
 		if (drawSubImage(makeYourMove, crop, panel->surface, pos) != 0){
-			SDL_FreeSurface(makeYourMove);
 			return 1;
 		}
-		
-		SDL_FreeSurface(makeYourMove);
-	}
-	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
 	}
 	
 	return 0;
@@ -706,15 +888,11 @@ int boardNumbersPanel_draw(Panel* panel){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/board_numbers.bmp", panel->surface, TILE_SIZE, 0) != 0){
-		return 1;
-	}
-	
-	if (drawImageByPath("Textures/board_numbers.bmp", panel->surface, 9.6*TILE_SIZE, 0) != 0){
+	if (drawTexture(TEXTURE_BOARD_NUMBERS, panel->surface, TILE_SIZE, 0) != 0){
 		return 1;
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
+	if (drawTexture(TEXTURE_BOARD_NUMBERS, panel->surface, 9.6*TILE_SIZE, 0) != 0){
 		return 1;
 	}
 	
@@ -726,7 +904,7 @@ int buttonsPanel_draw(Panel* panel){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/board_letters.bmp", panel->surface, 2*TILE_SIZE, 1.45*TILE_SIZE) != 0){
+	if (drawTexture(TEXTURE_BOARD_LETTERS, panel->surface, 2*TILE_SIZE, 1.45*TILE_SIZE) != 0){
 		return 1;
 	}
 	
@@ -738,10 +916,6 @@ int buttonsPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -750,11 +924,7 @@ int AISettingsHeaderPanel_draw(Panel* panel){
 		return 1;
 	}
 	
-	if(drawImageByPath("Textures/AISettingsHeader.bmp", panel->surface, 3.75*TILE_SIZE, 0)){
-		return 1;
-	}
-	
-	if(Panel_flipAndDraw(panel) != 0){
+	if(drawTexture(TEXTURE_AI_SETTINGS_HEADER, panel->surface, 3.75*TILE_SIZE, 0)){
 		return 1;
 	}
 	
@@ -767,11 +937,11 @@ int AISettingsRadiosPanel_draw(Panel* panel){
 		return 1;
 	}
 	
-	if(drawImageByPath("Textures/difficultyHeader.bmp", panel->surface, 1.5*TILE_SIZE, 0)){
+	if(drawTexture(TEXTURE_DIFFICULTY_HEADER, panel->surface, 1.5*TILE_SIZE, 0)){
 		return 1;
 	}
 	
-	if(drawImageByPath("Textures/AIColorHeader.bmp", panel->surface, 8*TILE_SIZE, 0)){
+	if(drawTexture(TEXTURE_AI_COLOR_HEADER, panel->surface, 8*TILE_SIZE, 0)){
 		return 1;
 	}
 	
@@ -784,10 +954,6 @@ int AISettingsRadiosPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -805,10 +971,6 @@ int AISettingsButtonsPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -816,7 +978,7 @@ int instructionsPanel_draw(Panel* panel){
 	if (fillBackground(panel)){
 		return 1;
 	}
-	if (drawImageByPath("Textures/instructions.bmp", panel->surface, 1.5*TILE_SIZE, 0.5*TILE_SIZE) != 0){
+	if (drawTexture(TEXTURE_INSTRUCTIONS, panel->surface, 1.5*TILE_SIZE, 0.5*TILE_SIZE) != 0){
 		return 1;
 	}
 		
@@ -829,10 +991,6 @@ int instructionsPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -841,15 +999,11 @@ int playerSettingsHeader_draw(Panel* panel){
 		return 1;
 	}	
 	
-	if (drawImageByPath("Textures/playerSettingsIcon.bmp", panel->surface, 4.2*TILE_SIZE, 2*TILE_SIZE)){
-		return 1;
-	}
-	
-	if(drawImageByPath("Textures/playerSettingsHeader.bmp", panel->surface, 3*TILE_SIZE ,0.5*TILE_SIZE) != 0){
+	if (drawTexture(TEXTURE_PLAYER_SETTINGS_ICON, panel->surface, 4.2*TILE_SIZE, 2*TILE_SIZE)){
 		return 1;
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
+	if(drawTexture(TEXTURE_PLAYER_SETTINGS_HEADER, panel->surface, 3*TILE_SIZE ,0.5*TILE_SIZE) != 0){
 		return 1;
 	}
 	
@@ -861,16 +1015,16 @@ int playerSettingsRadiosPanel_draw (Panel* panel){
 		return 1;
 	}	
 	
-	if (drawImageByPath("Textures/gameModeHeader.bmp", panel->surface, 1.8*TILE_SIZE, 0)){
+	if (drawTexture(TEXTURE_GAME_MODE_HEADER, panel->surface, 1.8*TILE_SIZE, 0)){
 		return 1;
 	}
 	
-	if (drawImageByPath("Textures/nextPlayerHeader.bmp", panel->surface, 7.8*TILE_SIZE, 0)){
+	if (drawTexture(TEXTURE_NEXT_PLAYER_HEADER, panel->surface, 7.8*TILE_SIZE, 0)){
 		return 1;
 	}
 	
 	if (gameMode == TWO_PLAYERS_MODE){
-		if(drawImageByPath("Textures/depthForHintsHeader.bmp", panel->surface, 3.7*TILE_SIZE, 1.8*TILE_SIZE)){
+		if(drawTexture(TEXTURE_DEPTH_FOR_HINTS_HEADER, panel->surface, 3.7*TILE_SIZE, 1.8*TILE_SIZE)){
 			return 1;
 		}
 		RadioGroup* depthForHintsRadioGroup = LinkedList_last(panel->children);
@@ -891,10 +1045,6 @@ int playerSettingsRadiosPanel_draw (Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -925,10 +1075,6 @@ int playerSettingsButtonsPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -937,7 +1083,7 @@ int saveLoadPanel_draw(Panel* panel, short save){
 		return 1;
 	}
 	
-	SDL_Surface* image = loadImage("Textures/saveLoad.bmp");
+	SDL_Surface* image = getTexture(TEXTURE_SAVE_LOAD);
 	if (!image){
 		return 1;
 	}
@@ -946,10 +1092,18 @@ int saveLoadPanel_draw(Panel* panel, short save){
 	if (drawSubImage(image, crop, panel->surface, pos)){
 		return 1;
 	}
-	SDL_FreeSurface(image);
 	
-	if (LinkedList_length(panel->children) <= 1){
-		if (drawImageByPath("Textures/noSaveSlots.bmp", panel->surface, 207, 256)){
+	short hasSlots = 0;
+	Iterator slots;
+	Iterator_init(&slots, panel->children);
+	while (Iterator_hasNext(&slots)){
+		Button* button = (Button*)Iterator_next(&slots);
+		if (button->id >= 100 && !button->hidden){
+			hasSlots = 1;
+		}
+	}
+	if (!hasSlots){
+		if (drawTexture(TEXTURE_NO_SAVE_SLOTS, panel->surface, 207, 256)){
 			return 1;
 		}
 	}
@@ -963,10 +1117,6 @@ int saveLoadPanel_draw(Panel* panel, short save){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -1019,10 +1169,6 @@ int promotionPanel_draw(Panel* panel){
 		}
 	}
 	
-	if(Panel_flipAndDraw(panel) != 0){
-		return 1;
-	}
-	
 	return 0;
 }
 
@@ -1033,39 +1179,118 @@ static Window* Window_new(int w, int h){
 	if(!window){
 		return NULL;
 	}
-	window->surface = SDL_SetVideoMode(w, h, 0, SDL_HWSURFACE | SDL_DOUBLEBUF);
+	// a single software buffer that every panel draws into directly, so that changed regions can be presented on their own
+	window->surface = SDL_SetVideoMode(w, h, 0, SDL_SWSURFACE);
 	if (!window->surface) {
 		printf("ERROR: failed to set video mode: %s\n", SDL_GetError());
 		return NULL;
 	}
-	window->children = LinkedList_new(&Panel_free);
-	if(!window->children){
+	// set by showScreen to the lists of the screen shown
+	window->children = NULL;
+	window->buttons = NULL;
+	window->radios = NULL;
+	return window;
+}
+
+//Screen functions
+
+/*
+ * Each screen is built the first time it is shown, and kept with its panels, buttons and radios
+ * until the program exits. Showing it again only makes its lists the window's.
+ */
+#define MAIN_MENU_SCREEN 0
+#define GAME_SCREEN 1
+#define AI_SETTINGS_SCREEN 2
+#define INSTRUCTIONS_SCREEN 3
+#define BOARD_SETTINGS_SCREEN 4
+#define PLAYER_SETTINGS_SCREEN 5
+#define SAVE_SCREEN 6
+#define LOAD_SCREEN 7
+#define NUM_OF_SCREENS 8
+
+static Screen* screens[NUM_OF_SCREENS];
+
+static Screen* Screen_new(){
+	Screen* screen = (Screen*)malloc(sizeof(Screen));
+	if (!screen){
+		printf("ERROR: standard function malloc has failed\n");
 		return NULL;
 	}
-	window->buttons = LinkedList_new(&Button_free);
-	if(!window->buttons){
-		LinkedList_free(window->children);
+	screen->children = LinkedList_new(&Panel_free);
+	if (!screen->children){
+		free(screen);
 		return NULL;
 	}
-	
-	window->radios = LinkedList_new(&Radio_free);
-	if(!window->radios){
-		LinkedList_free(window->children);
+	screen->buttons = LinkedList_new(&Button_free);
+	if (!screen->buttons){
+		LinkedList_free(screen->children);
+		free(screen);
 		return NULL;
 	}
-	
-	return window;
+	screen->radios = LinkedList_new(&Radio_free);
+	if (!screen->radios){
+		LinkedList_free(screen->children);
+		free(screen->buttons);
+		free(screen);
+		return NULL;
+	}
+	return screen;
 }
 
-void prepareWindowForNewScreen(){
-	LinkedList_removeAllAndFree(window->children);
-	LinkedList_removeAll(window->buttons);
-	LinkedList_removeAll(window->radios);
+/*
+ * Frees a screen and its panels. The buttons and radios are freed along with the panels holding them.
+ */
+static void Screen_free(Screen* screen){
+	LinkedList_free(screen->children);
+	LinkedList_removeAll(screen->buttons);
+	free(screen->buttons);
+	LinkedList_removeAll(screen->radios);
+	free(screen->radios);
+	free(screen);
 }
 
-int setScreenToMainMenu(){
-	prepareWindowForNewScreen();
-	
+/*
+ * Selects the radios of the current screen that match their parameters, 
+ * which may have changed since the screen was last shown.
+ */
+static void restoreRadios(){
+	Iterator iterator;
+	Iterator_init(&iterator, window->radios);
+	while (Iterator_hasNext(&iterator)){
+		Radio* radio = (Radio*)Iterator_next(&iterator);
+		radio->state = (radio->value == *(radio->group->parameter));
+		if (radio->state){
+			radio->group->selected = radio;
+		}
+	}
+}
+
+/*
+ * Makes the screen numbered (id) the current one, building it with (build) if it was never shown before.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+static int showScreen(int id, int (*build)()){
+	short isNew = !screens[id];
+	if (isNew){
+		screens[id] = Screen_new();
+		if (!screens[id]){
+			return 1;
+		}
+	}
+	window->children = screens[id]->children;
+	window->buttons = screens[id]->buttons;
+	window->radios = screens[id]->radios;
+	GUI_invalidateAll();
+	state = SETTINGS;
+	if (isNew && build()){
+		return 1;
+	}
+	setAllButtonsToNormal();
+	restoreRadios();
+	return 0;
+}
+
+static int buildMainMenuScreen(){
 	SDL_Rect rect = {0, 0, 768, 768};
 	Panel* mainMenuPanel = Panel_new(window->surface, rect, &MainMenu_draw);
 	if(!mainMenuPanel){
@@ -1093,14 +1318,11 @@ int setScreenToMainMenu(){
 	return 0;
 }
 
-int setScreenToGame(short calledAtBeginningOfGame){
-	prepareWindowForNewScreen();
-	selectedX = 0;
-	
-	if (calledAtBeginningOfGame){
-		turn = first;
-	}
+int setScreenToMainMenu(){
+	return showScreen(MAIN_MENU_SCREEN, &buildMainMenuScreen);
+}
 
+static int buildGameScreen(){
 	SDL_Rect announcementsRect = {0, 10*TILE_SIZE, 12*TILE_SIZE, 2*TILE_SIZE};
 	Panel* announcementsPanel = Panel_new(window->surface, announcementsRect, &announcementsPanel_draw);
 	if(!announcementsPanel){
@@ -1198,9 +1420,21 @@ int setScreenToGame(short calledAtBeginningOfGame){
 	return 0;
 }
 
-int setScreenToAISettings(){
-	prepareWindowForNewScreen();
+int setScreenToGame(short calledAtBeginningOfGame){
+	if (showScreen(GAME_SCREEN, &buildGameScreen)){
+		return 1;
+	}
+	state = GAME;
+	selectedX = 0;
 	
+	if (calledAtBeginningOfGame){
+		turn = first;
+		Board_setSideToMove(&board, turn);
+	}
+	return 0;
+}
+
+static int buildAISettingsScreen(){
 	SDL_Rect AISettingsHeaderPanelRect = {0, 0, 12*TILE_SIZE, TILE_SIZE}; 
 	Panel* AISettingsHeaderPanel = Panel_new(window->surface, AISettingsHeaderPanelRect, &AISettingsHeaderPanel_draw);
 	if (!AISettingsHeaderPanel){
@@ -1294,8 +1528,11 @@ int setScreenToAISettings(){
 	return 0;
 }
 
-int setScreenToInstructions(){
-	prepareWindowForNewScreen();
+int setScreenToAISettings(){
+	return showScreen(AI_SETTINGS_SCREEN, &buildAISettingsScreen);
+}
+
+static int buildInstructionsScreen(){
 	SDL_Rect instructionsRect = {0, 0, 12*TILE_SIZE, 12*TILE_SIZE};
 	Panel* instructionsPanel = Panel_new(window->surface, instructionsRect, &instructionsPanel_draw);
 	if (!instructionsPanel){
@@ -1318,16 +1555,11 @@ int setScreenToInstructions(){
 	return 0;
 }
 
-int setScreenToBoardSettings(){
-	prepareWindowForNewScreen();
-	
-	copyOfMainBoard = Board_new();
-	if (!copyOfMainBoard){
-		return 1;
-	}
-	Board_copy(copyOfMainBoard, &board);
-	PieceCounter_copy(copyOfMainPieceCounter, counter);
-	
+int setScreenToInstructions(){
+	return showScreen(INSTRUCTIONS_SCREEN, &buildInstructionsScreen);
+}
+
+static int buildBoardSettingsScreen(){
 	SDL_Rect headerRect = {0, 0, 12*TILE_SIZE, 3*TILE_SIZE};
 	Panel* headerPanel = Panel_new(window->surface, headerRect, &boardSettingsHeaderPanel_draw);
 	if(!headerPanel){
@@ -1388,10 +1620,21 @@ int setScreenToBoardSettings(){
 	return 0;
 }
 
-
-int setScreenToPlayerSettings(){
-	prepareWindowForNewScreen();
+int setScreenToBoardSettings(){
+	if (showScreen(BOARD_SETTINGS_SCREEN, &buildBoardSettingsScreen)){
+		return 1;
+	}
 	
+	copyOfMainBoard = Board_new();
+	if (!copyOfMainBoard){
+		return 1;
+	}
+	Board_copy(copyOfMainBoard, &board);
+	PieceCounter_copy(copyOfMainPieceCounter, counter);
+	return 0;
+}
+
+static int buildPlayerSettingsScreen(){
 	SDL_Rect playerSettingsRadiosRect = {0, 5*TILE_SIZE, 12*TILE_SIZE, 4.5*TILE_SIZE};
 	Panel* playerSettingsRadiosPanel = Panel_new(window->surface, playerSettingsRadiosRect, &playerSettingsRadiosPanel_draw);
 	if (!playerSettingsRadiosPanel){
@@ -1525,9 +1768,11 @@ int setScreenToPlayerSettings(){
 	return 0;
 }
 
-int setScreenToSaveLoad(short save){
-	prepareWindowForNewScreen();
-	
+int setScreenToPlayerSettings(){
+	return showScreen(PLAYER_SETTINGS_SCREEN, &buildPlayerSettingsScreen);
+}
+
+static int buildSaveLoadScreen(short save){
 	SDL_Rect rect = {0, 0, 768, 768};
 	Panel* saveLoadPanel = save? 	Panel_new(window->surface, rect, &savePanel_draw):
 									Panel_new(window->surface, rect, &loadPanel_draw);
@@ -1541,14 +1786,6 @@ int setScreenToSaveLoad(short save){
 	}
 	
 	for (int i = 0; i < NUMBER_OF_SAVE_SLOTS; i++){
-		if (!save){
-			char buf[12];
-			sprintf(buf, "slot%02d.xml", i);
-			const char* path = &buf[0];
-			if (access(path, R_OK)){
-				continue;
-			}
-		}
 		int row = i/4;
 		int col = i%4;
 		SDL_Rect pos = {128+col*128, 128+row*128, 128, 128};
@@ -1568,17 +1805,52 @@ int setScreenToSaveLoad(short save){
 	return 0;
 }
 
+static int buildSaveScreen(){
+	return buildSaveLoadScreen(1);
+}
+
+static int buildLoadScreen(){
+	return buildSaveLoadScreen(0);
+}
+
+int setScreenToSaveLoad(short save){
+	if (showScreen(save? SAVE_SCREEN: LOAD_SCREEN, save? &buildSaveScreen: &buildLoadScreen)){
+		return 1;
+	}
+	if (save){
+		return 0;
+	}
+	
+	// only slots holding a saved game can be loaded, and these may have changed since the screen was built
+	Iterator iterator;
+	Iterator_init(&iterator, window->buttons);
+	while (Iterator_hasNext(&iterator)){
+		Button* button = (Button*)Iterator_next(&iterator);
+		if (button->id >= 200){
+			char path[20];
+			sprintf(path, "slot%02d.xml", button->id-200);
+			button->hidden = (access(path, R_OK) != 0);
+		}
+	}
+	return 0;
+}
+
 static void Window_free(){
-	LinkedList_free(window->children);
+	for (int i = 0; i < NUM_OF_SCREENS; i++){
+		if (screens[i]){
+			Screen_free(screens[i]);
+		}
+	}
 	if (movesOfSelectedPiece){
-		LinkedList_free(movesOfSelectedPiece);
+		LinkedList_removeAll(movesOfSelectedPiece);
+		free(movesOfSelectedPiece);
 	}
 	
-	LinkedList_removeAll(window->buttons);
-	free(window->buttons);
-	LinkedList_removeAll(window->radios);
-	free(window->radios);
 	free(window);
+	freeTextures();
+	if (boardBackground){
+		SDL_FreeSurface(boardBackground);
+	}
 	SDL_Quit();
 }
 
@@ -1599,31 +1871,197 @@ int GUI_init(){
 	if(!window){
 		return 1;
 	}
+	if (loadTextures() || createBoardBackground()){
+		return 1;
+	}
 	if(setScreenToMainMenu()){
 		return 1;
 	}
 	return 0;
 }
 
-int GUI_paint(){
-	// Clear window to background white
-	if (SDL_FillRect(window->surface, 0, BACKGROUND_WHITE) != 0) {
+/*
+ * What the board panels and the announcements showed when they were last painted,
+ * compared against the current state to find the regions that changed.
+ */
+static Board drawnBoard;
+static uint64_t drawnHighlights;
+static int drawnStatus[10];
+
+/*
+ * @return: the set of tiles highlighted on the game board: the selected tile and the moves of the selected piece
+ */
+static uint64_t getHighlightedTiles(){
+	uint64_t highlights = 0;
+	if (selectedX != 0 && Board_isInRange(selectedX, selectedY)){
+		highlights |= (uint64_t)1 << Board_SQUARE(selectedX, selectedY);
+	}
+	if (movesOfSelectedPiece){
+		Iterator iterator;
+		Iterator_init(&iterator, movesOfSelectedPiece);
+		while (Iterator_hasNext(&iterator)){
+			int x, y;
+			getHighlightedTile((PossibleMove*)Iterator_next(&iterator), &x, &y);
+			if (Board_isInRange(x, y)){
+				highlights |= (uint64_t)1 << Board_SQUARE(x, y);
+			}
+		}
+	}
+	return highlights;
+}
+
+/*
+ * Marks the tiles of the board panel whose piece or highlight changed since they were last painted.
+ */
+static void invalidateChangedTiles(Panel* panel, Board* shownBoard, uint64_t highlights){
+	for (int x = 1; x <= 8; x++){
+		for (int y = 1; y <= 8; y++){
+			uint64_t tile = (uint64_t)1 << Board_SQUARE(x, y);
+			if (Board_getPiece(shownBoard, x, y) != Board_getPiece(&drawnBoard, x, y) || ((highlights ^ drawnHighlights) & tile)){
+				invalidate(Rect_new(panel->rect.x + (x-1)*TILE_SIZE, panel->rect.y + (8-y)*TILE_SIZE, TILE_SIZE, TILE_SIZE));
+			}
+		}
+	}
+	Board_copy(&drawnBoard, shownBoard);
+	drawnHighlights = highlights;
+}
+
+/*
+ * Compares the state the panels show with the state they were last painted with, and marks what changed:
+ * the tiles of the board whose piece or highlight changed, and, when the turn, the game's outcome or 
+ * the settings changed, every panel but the board and its numbers, which do not show them.
+ */
+static void findChangedRegions(){
+	int status[] = {turn, isInCheck, gameEnded, chosePromotionMove, gameMode, player1, first, 
+			maxRecursionDepth, settingInvalidPiece, kingIsMissing};
+	int statusChanged = memcmp(status, drawnStatus, sizeof(status)) != 0;
+	memcpy(drawnStatus, status, sizeof(status));
+	
+	Iterator iterator;
+	Iterator_init(&iterator, window->children);
+	while(Iterator_hasNext(&iterator)){
+		Panel* panel = (Panel*)Iterator_next(&iterator);
+		if (panel->drawFunc == &gameBoardPanel_draw){
+			invalidateChangedTiles(panel, &board, getHighlightedTiles());
+		}
+		else if (panel->drawFunc == &settingsBoardPanel_draw){
+			invalidateChangedTiles(panel, copyOfMainBoard, 0);
+		}
+		else if (statusChanged && panel->drawFunc != &boardNumbersPanel_draw){
+			invalidate(panel->rect);
+		}
+	}
+}
+
+/*
+ * Redraws the region (rect) of the window: every panel overlapping it draws itself, clipped to it.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+static int paintRect(SDL_Rect rect){
+	SDL_SetClipRect(window->surface, &rect);
+	if (SDL_FillRect(window->surface, &rect, mapColor(window->surface, BACKGROUND_WHITE)) != 0) {
 		printf("ERROR: failed to draw rect: %s\n", SDL_GetError());
 		return 1;
 	}
-	
-	//draw all panels
 	Iterator iterator;
 	Iterator_init(&iterator, window->children);
 	while(Iterator_hasNext(&iterator)){
 		Panel* panel = (Panel*)Iterator_next(&iterator);
-		if (panel->drawFunc(panel)){
+		if (!Rect_intersects(rect, panel->rect)){
+			continue;
+		}
+		SDL_Rect clip = Rect_new(rect.x - panel->rect.x, rect.y - panel->rect.y, rect.w, rect.h);
+		SDL_SetClipRect(panel->surface, &clip);
+		int error = panel->drawFunc(panel);
+		SDL_SetClipRect(panel->surface, NULL);
+		if (error){
 			return 1;
 		}
 	}
+	return 0;
+}
+
+int GUI_paint(){
+	findChangedRegions();
+	// nothing changed, so nothing is drawn or presented
+	if (numOfDirtyRects == 0){
+		return 0;
+	}
+	
+	//draw the changed regions
+	for (int i = 0; i < numOfDirtyRects; i++){
+		if (paintRect(dirtyRects[i])){
+			SDL_SetClipRect(window->surface, NULL);
+			return 1;
+		}
+	}
+	SDL_SetClipRect(window->surface, NULL);
 	
 	// We finished drawing
-	if (flipBuffer(window->surface)) {
+	SDL_UpdateRects(window->surface, numOfDirtyRects, dirtyRects);
+	numOfDirtyRects = 0;
+	wholeWindowIsDirty = 0;
+	return 0;
+}
+
+/*
+ * Times the game board panel redrawing the whole board and redrawing a single tile, 
+ * and prints the average time of each in microseconds. Nothing is presented.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+int GUI_benchmarkBoard(){
+	if (setScreenToGame(1)){
+		return 1;
+	}
+	Panel* boardPanel = NULL;
+	Iterator iterator;
+	Iterator_init(&iterator, window->children);
+	while (Iterator_hasNext(&iterator)){
+		Panel* panel = (Panel*)Iterator_next(&iterator);
+		if (panel->drawFunc == &gameBoardPanel_draw){
+			boardPanel = panel;
+		}
+	}
+	if (!boardPanel){
+		return 1;
+	}
+	
+	const char* names[] = {"Whole board", "Single tile"};
+	SDL_Rect regions[] = {Rect_new(0, 0, 8*TILE_SIZE, 8*TILE_SIZE), Rect_new(4*TILE_SIZE, 6*TILE_SIZE, TILE_SIZE, TILE_SIZE)};
+	for (int i = 0; i < 2; i++){
+		long numOfRedraws = 0;
+		clock_t start = clock();
+		clock_t end = start;
+		SDL_SetClipRect(boardPanel->surface, &regions[i]);
+		while (end - start < CLOCKS_PER_SEC/2){
+			// clock is only read once in a while, as a redraw may take less time than reading it
+			for (int j = 0; j < 100; j++){
+				if (boardPanel->drawFunc(boardPanel)){
+					SDL_SetClipRect(boardPanel->surface, NULL);
+					return 1;
+				}
+			}
+			numOfRedraws += 100;
+			end = clock();
+		}
+		SDL_SetClipRect(boardPanel->surface, NULL);
+		printf("%s: %.2f microseconds per redraw\n", names[i], (end - start)*1000000.0/CLOCKS_PER_SEC/numOfRedraws);
+	}
+	return 0;
+}
+
+/*
+ * Wakes the event loop up with an SDL_USEREVENT of the given code. Safe to call from any thread.
+ * @return: 1 if any failures occured, 0 otherwise
+ */
+int GUI_pushEvent(int code){
+	SDL_Event event;
+	event.type = SDL_USEREVENT;
+	event.user.code = code;
+	event.user.data1 = NULL;
+	event.user.data2 = NULL;
+	if (SDL_PushEvent(&event)){
+		printf("ERROR: failed to push event: %s\n", SDL_GetError());
 		return 1;
 	}
 	return 0;
@@ -51,6 +51,16 @@
 #define HINT 34
 #define INSTRUCTIONS 35
 
+/* codes of the SDL_USEREVENT events that wake the event loop up */
+#define GUI_TIMER_EVENT   1
+#define GUI_AI_DONE_EVENT 2
+
+typedef struct Screen{
+	LinkedList* children;
+	LinkedList* buttons;
+	LinkedList* radios;
+} Screen;
+
 typedef struct Window{
 	SDL_Surface* surface;
 	LinkedList* children;
@@ -112,6 +122,12 @@ int GUI_init();
 
 int GUI_paint();
 
+void GUI_invalidateAll();
+
+int GUI_pushEvent(int code);
+
+int GUI_benchmarkBoard();
+
 void Button_setToNormal(Button* button);
 
 void Button_setToHovered(Button* button);
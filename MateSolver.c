@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include "MateSolver.h"
+#include "PossibleMoveList.h"
+#include "Iterator.h"
+
+#define SOLVED_POSITIONS_SIZE (1 << 16)
+
+/*
+ * What is known about a position with the attacker to move, indexed by the low bits of its key:
+ * the attacker mates within (mateIn) moves (0 if not proven yet), but not within (noMateIn) moves.
+ */
+typedef struct SolvedPosition{
+	uint64_t key;
+	// ints, so that any number of moves the solver is asked about fits; the entry takes 16 bytes either way
+	int mateIn;
+	int noMateIn;
+} SolvedPosition;
+
+static SolvedPosition solvedPositions[SOLVED_POSITIONS_SIZE];
+
+/*
+ * Remembers whether the attacker to move on (board) mates within (moves) moves.
+ */
+static void storeResult(Board* board, int moves, int mates){
+	SolvedPosition* entry = &solvedPositions[board->key & (SOLVED_POSITIONS_SIZE-1)];
+	if (entry->key != board->key){
+		entry->key = board->key;
+		entry->mateIn = 0;
+		entry->noMateIn = 0;
+	}
+	if (mates){
+		if (entry->mateIn == 0 || moves < entry->mateIn){
+			entry->mateIn = moves;
+		}
+	}
+	else if (moves > entry->noMateIn){
+		entry->noMateIn = moves;
+	}
+}
+
+static int attackerMates(Board* board, int attacker, int moves);
+
+/*
+ * @params: (moves) - the number of moves the attacker has left, after the defender's move
+ * @return: 1 if (defender), to move on (board), is mated whatever it plays,
+ *          0 if it has a defense, -1 if an allocation error occurred
+ */
+static int defenderLoses(Board* board, int defender, int moves){
+	if (moves == 0){
+		int canMove = Board_possibleMovesExist(board, defender);
+		if (canMove == -1){
+			return -1;
+		}
+		return !canMove && Board_isInCheck(board, defender);
+	}
+	LinkedList* defenses = Board_getPossibleMoves(board, defender);
+	if (!defenses){
+		return -1;
+	}
+	int result = 1;
+	if (LinkedList_length(defenses) == 0){ // mate or stalemate
+		result = Board_isInCheck(board, defender);
+	}
+	Iterator iterator;
+	Iterator_init(&iterator, defenses);
+	while (result == 1 && Iterator_hasNext(&iterator)){
+		PossibleMove* defense = (PossibleMove*)Iterator_next(&iterator);
+		result = attackerMates(defense->board, !defender, moves);
+	}
+	PossibleMoveList_free(defenses);
+	return result;
+}
+
+/*
+ * @return: 1 if (attacker), to move on (board), mates within (moves) moves whatever the defense,
+ *          0 if it does not, -1 if an allocation error occurred
+ */
+static int attackerMates(Board* board, int attacker, int moves){
+	SolvedPosition* entry = &solvedPositions[board->key & (SOLVED_POSITIONS_SIZE-1)];
+	if (entry->key == board->key){
+		if (entry->mateIn != 0 && entry->mateIn <= moves){
+			return 1;
+		}
+		if (entry->noMateIn >= moves){
+			return 0;
+		}
+	}
+	LinkedList* possibleMoves = Board_getPossibleMoves(board, attacker);
+	if (!possibleMoves){
+		return -1;
+	}
+	int result = 0;
+	// checks first, then the other moves, unless this is the last move and only a check can mate
+	for (int checks = 1; result == 0 && checks >= (moves == 1); checks--){
+		Iterator iterator;
+		Iterator_init(&iterator, possibleMoves);
+		while (result == 0 && Iterator_hasNext(&iterator)){
+			PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
+			if (Board_isInCheck(move->board, !attacker) == checks){
+				result = defenderLoses(move->board, !attacker, moves-1);
+			}
+		}
+	}
+	PossibleMoveList_free(possibleMoves);
+	if (result != -1){
+		storeResult(board, moves, result);
+	}
+	return result;
+}
+
+/*
+ * @return: the number of moves (attacker), to move on (board), needs to mate,
+ *          given that it mates within (moves) moves, -1 if an allocation error occurred
+ */
+static int getMateLength(Board* board, int attacker, int moves){
+	for (int length = 1; length < moves; length++){
+		int mates = attackerMates(board, attacker, length);
+		if (mates != 0){
+			return (mates == 1)? length: -1;
+		}
+	}
+	return moves;
+}
+
+/*
+ * Appends to (line) the moves of a mate of (attacker) in (moves) moves,
+ * the defender putting up the longest resistance.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int addMatingLine(Board* board, int attacker, int moves, LinkedList* line){
+	LinkedList* possibleMoves = Board_getPossibleMoves(board, attacker);
+	if (!possibleMoves){
+		return -1;
+	}
+	PossibleMove* keyMove = NULL;
+	Iterator iterator;
+	Iterator_init(&iterator, possibleMoves);
+	while (!keyMove && Iterator_hasNext(&iterator)){
+		PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
+		int mates = defenderLoses(move->board, !attacker, moves-1);
+		if (mates == -1){
+			PossibleMoveList_free(possibleMoves);
+			return -1;
+		}
+		if (mates){
+			keyMove = move;
+		}
+	}
+	LinkedList_freeAllButOne(possibleMoves, keyMove);
+	if (!keyMove){
+		return 0;
+	}
+	if (LinkedList_add(line, keyMove)){
+		PossibleMove_free(keyMove);
+		return -1;
+	}
+	if (moves == 1){
+		return 0;
+	}
+
+	LinkedList* defenses = Board_getPossibleMoves(keyMove->board, !attacker);
+	if (!defenses){
+		return -1;
+	}
+	PossibleMove* bestDefense = NULL;
+	int longestMate = 0;
+	Iterator_init(&iterator, defenses);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* defense = (PossibleMove*)Iterator_next(&iterator);
+		int length = getMateLength(defense->board, attacker, moves-1);
+		if (length == -1){
+			PossibleMoveList_free(defenses);
+			return -1;
+		}
+		if (length > longestMate){
+			longestMate = length;
+			bestDefense = defense;
+		}
+	}
+	LinkedList_freeAllButOne(defenses, bestDefense);
+	if (!bestDefense){ // the key move already mates
+		return 0;
+	}
+	if (LinkedList_add(line, bestDefense)){
+		PossibleMove_free(bestDefense);
+		return -1;
+	}
+	return addMatingLine(bestDefense->board, attacker, longestMate, line);
+}
+
+/*
+ * Searches for the shortest mate of (player), to move on (board), within (maxMoves) of its moves.
+ *
+ * @params: (line) - filled with the moves of both players along the mate, if one is found
+ * @return: the number of moves (player) needs to mate, 0 if it cannot mate within (maxMoves) moves,
+ *          -1 if an allocation error occurred
+ */
+int MateSolver_solve(Board* board, int player, int maxMoves, LinkedList* line){
+	for (int moves = 1; moves <= maxMoves; moves++){
+		int mates = attackerMates(board, player, moves);
+		if (mates == -1){
+			return -1;
+		}
+		if (mates){
+			return addMatingLine(board, player, moves, line)? -1: moves;
+		}
+	}
+	return 0;
+}
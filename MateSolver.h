@@ -0,0 +1,16 @@
+#ifndef MATESOLVER_H
+#define MATESOLVER_H
+
+#include "Board.h"
+#include "LinkedList.h"
+
+/*
+ * Searches for forced mates only, instead of scoring positions by material:
+ * the attacker tries its checking moves first and, on its last move, nothing but checks,
+ * and the defender must have an answer to every one of them.
+ * Positions already proven or refuted are remembered between searches.
+ */
+
+int MateSolver_solve(Board* board, int player, int maxMoves, LinkedList* line);
+
+#endif
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include "MoveGenerator.h"
+#include "PossibleMoveList.h"
+
+#define HASH_MOVES_SIZE (1 << 16)
+
+/*
+ * The best move found on each position searched, indexed by the low bits of the position's key.
+ * A move is only stored as its coordinates, and is checked to be legal before it is used.
+ */
+typedef struct HashMove{
+	uint64_t key;
+	char fromX, fromY, toX, toY;
+	char promotion;
+} HashMove;
+
+static HashMove hashMoves[HASH_MOVES_SIZE];
+
+/*
+ * @return: 1 if (move) is the move described by (entry), 0 otherwise
+ */
+static int isHashMove(HashMove* entry, PossibleMove* move){
+	return entry->fromX == move->fromX && entry->fromY == move->fromY
+		&& entry->toX == move->toX && entry->toY == move->toY
+		&& entry->promotion == move->promotion;
+}
+
+/*
+ * Remembers (move) as the best move found on (board).
+ */
+void MoveGenerator_storeBestMove(Board* board, PossibleMove* move){
+	HashMove* entry = &hashMoves[board->key & (HASH_MOVES_SIZE-1)];
+	entry->key = board->key;
+	entry->fromX = move->fromX;
+	entry->fromY = move->fromY;
+	entry->toX = move->toX;
+	entry->toY = move->toY;
+	entry->promotion = move->promotion;
+}
+
+/*
+ * Looks up the best move previously stored for the generator's board.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise.
+ *          (generator->hashMove) is set to the move if it is stored and legal, NULL otherwise.
+ */
+static int findHashMove(MoveGenerator* generator){
+	Board* board = generator->board;
+	HashMove* entry = &hashMoves[board->key & (HASH_MOVES_SIZE-1)];
+	generator->hashMove = NULL;
+	if (entry->key != board->key || entry->fromX == 0 || entry->toX == 0
+			|| Board_getColor(board, entry->fromX, entry->fromY) != generator->player){
+		return 0;
+	}
+	LinkedList* pieceMoves = Board_getPossibleMovesOfPiece(board, entry->fromX, entry->fromY, 1);
+	if (!pieceMoves){
+		return -1;
+	}
+	Iterator iterator;
+	Iterator_init(&iterator, pieceMoves);
+	while (Iterator_hasNext(&iterator)){
+		PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
+		if (isHashMove(entry, move)){
+			generator->hashMove = move;
+			break;
+		}
+	}
+	LinkedList_freeAllButOne(pieceMoves, generator->hashMove);
+	return 0;
+}
+
+/*
+ * Initializes a generator of the moves of (player) on (board).
+ * Nothing is generated until the first move is requested.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+int MoveGenerator_init(MoveGenerator* generator, Board* board, int player){
+	generator->board = board;
+	generator->player = player;
+	generator->stage = MoveGenerator_START;
+	generator->hashMove = NULL;
+	generator->stageMoves = NULL;
+	generator->badCaptures = NULL;
+	generator->usedMoves = PossibleMoveList_new();
+	if (!generator->usedMoves){
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * @return: how much material (move) is expected to win, 
+ *          including the value gained by a promotion
+ */
+static int getCaptureValue(Board* board, PossibleMove* move){
+	int value = Board_getStaticExchange(board, move->fromX, move->fromY, move->toX, move->toY);
+	if (move->promotion){
+		value += abs(Board_VALUE_OF(move->promotion)) - abs(Board_VALUE_OF(Board_WHITE_PAWN));
+	}
+	return value;
+}
+
+/*
+ * Sorts the captures of the current stage by the material they are expected to win, best first,
+ * and sets aside the captures that lose material for the last stage.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int orderCaptures(MoveGenerator* generator){
+	LinkedList* captures = generator->stageMoves;
+	int numOfCaptures = LinkedList_length(captures);
+	generator->badCaptures = PossibleMoveList_new();
+	if (!generator->badCaptures){
+		return -1;
+	}
+	if (numOfCaptures == 0){
+		return 0;
+	}
+	PossibleMove** moves = (PossibleMove**)malloc(numOfCaptures*sizeof(PossibleMove*));
+	int* values = (int*)malloc(numOfCaptures*sizeof(int));
+	if (!moves || !values){
+		free(moves);
+		free(values);
+		return -1;
+	}
+	Iterator iterator;
+	Iterator_init(&iterator, captures);
+	for (int i = 0; Iterator_hasNext(&iterator); i++){ // insertion sort
+		PossibleMove* move = (PossibleMove*)Iterator_next(&iterator);
+		int value = getCaptureValue(generator->board, move);
+		int j = i;
+		while (j > 0 && values[j-1] < value){
+			moves[j] = moves[j-1];
+			values[j] = values[j-1];
+			j--;
+		}
+		moves[j] = move;
+		values[j] = value;
+	}
+	LinkedList_removeAll(captures);
+	int exitcode = 0;
+	for (int i = 0; i < numOfCaptures; i++){
+		LinkedList* list = (values[i] >= 0)? captures: generator->badCaptures;
+		if (LinkedList_add(list, moves[i])){
+			PossibleMove_free(moves[i]);
+			exitcode = -1;
+		}
+	}
+	free(moves);
+	free(values);
+	return exitcode;
+}
+
+/*
+ * Generates the moves of the generator's next stage.
+ *
+ * @return: -1 if an allocation error occurred, 0 otherwise
+ */
+static int generateNextStage(MoveGenerator* generator){
+	if (generator->stageMoves){
+		LinkedList_concatenateAndFree(generator->usedMoves, generator->stageMoves);
+		generator->stageMoves = NULL;
+	}
+	switch (generator->stage){
+		case MoveGenerator_HASH_MOVE:
+			generator->stage = Board_isInCheck(generator->board, generator->player)?
+					MoveGenerator_EVASIONS:
+					MoveGenerator_CAPTURES;
+			break;
+		case MoveGenerator_CAPTURES:
+			generator->stage = MoveGenerator_QUIETS;
+			break;
+		case MoveGenerator_QUIETS:
+			generator->stage = MoveGenerator_BAD_CAPTURES;
+			break;
+		default:
+			generator->stage = MoveGenerator_DONE;
+			return 0;
+	}
+	switch (generator->stage){
+		case MoveGenerator_CAPTURES:
+			generator->stageMoves = Board_getPossibleMovesOfKinds(generator->board, generator->player, Board_CAPTURES);
+			if (generator->stageMoves && orderCaptures(generator)){
+				return -1;
+			}
+			break;
+		case MoveGenerator_QUIETS:
+			generator->stageMoves = Board_getPossibleMovesOfKinds(generator->board, generator->player, Board_QUIETS);
+			break;
+		case MoveGenerator_BAD_CAPTURES:
+			generator->stageMoves = generator->badCaptures;
+			generator->badCaptures = NULL;
+			break;
+		case MoveGenerator_EVASIONS:
+			generator->stageMoves = Board_getEvasions(generator->board, generator->player);
+			break;
+	}
+	if (!generator->stageMoves){
+		return -1;
+	}
+	Iterator_init(&generator->iterator, generator->stageMoves);
+	return 0;
+}
+
+/*
+ * Yields the next possible move.
+ *
+ * @params: (error) - set to 1 if an allocation error occurred, 0 otherwise
+ * @return: the next move, NULL if there are no more moves or an error occurred
+ */
+PossibleMove* MoveGenerator_next(MoveGenerator* generator, int* error){
+	*error = 0;
+	if (generator->stage == MoveGenerator_START){
+		generator->stage = MoveGenerator_HASH_MOVE;
+		if (findHashMove(generator)){
+			*error = 1;
+			return NULL;
+		}
+		if (generator->hashMove){
+			return generator->hashMove;
+		}
+	}
+	while (generator->stage != MoveGenerator_DONE){
+		while (generator->stageMoves && Iterator_hasNext(&generator->iterator)){
+			PossibleMove* move = (PossibleMove*)Iterator_next(&generator->iterator);
+			// the hash move was already yielded
+			if (generator->hashMove && PossibleMove_equals(move, generator->hashMove)
+					&& move->promotion == generator->hashMove->promotion){
+				continue;
+			}
+			return move;
+		}
+		if (generateNextStage(generator)){
+			*error = 1;
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Frees the moves held by the generator, including the ones it yielded.
+ */
+void MoveGenerator_free(MoveGenerator* generator){
+	if (generator->hashMove){
+		PossibleMove_free(generator->hashMove);
+	}
+	if (generator->stageMoves){
+		PossibleMoveList_free(generator->stageMoves);
+	}
+	if (generator->badCaptures){
+		PossibleMoveList_free(generator->badCaptures);
+	}
+	PossibleMoveList_free(generator->usedMoves);
+}
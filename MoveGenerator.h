@@ -0,0 +1,42 @@
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include "Board.h"
+#include "LinkedList.h"
+#include "Iterator.h"
+
+#define MoveGenerator_START     0
+#define MoveGenerator_HASH_MOVE 1
+#define MoveGenerator_CAPTURES  2
+#define MoveGenerator_QUIETS    3
+#define MoveGenerator_BAD_CAPTURES 4
+#define MoveGenerator_EVASIONS  5
+#define MoveGenerator_DONE      6
+
+/*
+ * Yields the possible moves of a player one at a time, generating them in stages:
+ * the best move previously found on the same position, then captures and promotions that do not lose
+ * material, best first, then all other moves, and last the captures that lose material.
+ * When the player is in check, only evasions are generated after the hash move.
+ * The yielded moves stay valid until the generator is freed.
+ */
+typedef struct MoveGenerator{
+	Board* board;
+	int player;
+	int stage;
+	PossibleMove* hashMove;
+	LinkedList* stageMoves;
+	LinkedList* badCaptures;
+	LinkedList* usedMoves;
+	Iterator iterator;
+} MoveGenerator;
+
+int MoveGenerator_init(MoveGenerator* generator, Board* board, int player);
+
+PossibleMove* MoveGenerator_next(MoveGenerator* generator, int* error);
+
+void MoveGenerator_storeBestMove(Board* board, PossibleMove* move);
+
+void MoveGenerator_free(MoveGenerator* generator);
+
+#endif
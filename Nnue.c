@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_SIMD
+#endif
+
+#include "Nnue.h"
+
+#define NUM_OF_SQUARES  (Board_SIZE*Board_SIZE)
+#define NUM_OF_FEATURES (2*6*NUM_OF_SQUARES)
+#define NUM_OF_HIDDEN   128
+#define CLIP            127
+#define OUTPUT_SCALE    16
+#define MAX_PLY         64
+#define MAX_UPDATES     8   /* more changed features than this and the accumulator is summed again */
+
+/*
+ * The first layer's output for a board, from each player's side of the board.
+ */
+typedef struct Accumulator{
+	int16_t values[2][NUM_OF_HIDDEN];
+} __attribute__((aligned(32))) Accumulator;
+
+/*
+ * The accumulator last computed at a ply of the search, and the squares of the board it belongs to.
+ */
+typedef struct StackEntry{
+	Accumulator accumulator;
+	unsigned char squares[32];
+	int valid;
+} StackEntry;
+
+static int16_t featureWeights[NUM_OF_FEATURES][NUM_OF_HIDDEN] __attribute__((aligned(32)));
+static int16_t featureBiases[NUM_OF_HIDDEN] __attribute__((aligned(32)));
+static int16_t outputWeights[2][NUM_OF_HIDDEN] __attribute__((aligned(32)));
+static int32_t outputBias;
+static int loaded = 0;
+
+static StackEntry stack[MAX_PLY];
+
+/*
+ * The kernels adding and subtracting a row of feature weights, and computing the output layer.
+ * Each has a plain C version, and SSE4.1 and AVX2 versions compiled for those instruction sets alone, 
+ * so the program runs on any processor; chooseKernels picks the fastest the processor supports.
+ */
+static void addRowLoop(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i++){
+		values[i] += row[i];
+	}
+}
+
+static void subtractRowLoop(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i++){
+		values[i] -= row[i];
+	}
+}
+
+/*
+ * @return: the output layer's result for the clipped accumulators of the player to move (own) and of the other player
+ */
+static int32_t getOutputLoop(const int16_t* own, const int16_t* other){
+	int32_t sum = outputBias;
+	for (int i = 0; i < NUM_OF_HIDDEN; i++){
+		int ownValue = (own[i] < 0)? 0: (own[i] > CLIP)? CLIP: own[i];
+		int otherValue = (other[i] < 0)? 0: (other[i] > CLIP)? CLIP: other[i];
+		sum += ownValue*outputWeights[0][i] + otherValue*outputWeights[1][i];
+	}
+	return sum;
+}
+
+#ifdef NNUE_SIMD
+__attribute__((target("sse4.1")))
+static void addRowSse41(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 8){
+		__m128i sum = _mm_add_epi16(_mm_load_si128((const __m128i*)(values + i)),
+				_mm_load_si128((const __m128i*)(row + i)));
+		_mm_store_si128((__m128i*)(values + i), sum);
+	}
+}
+
+__attribute__((target("sse4.1")))
+static void subtractRowSse41(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 8){
+		__m128i difference = _mm_sub_epi16(_mm_load_si128((const __m128i*)(values + i)),
+				_mm_load_si128((const __m128i*)(row + i)));
+		_mm_store_si128((__m128i*)(values + i), difference);
+	}
+}
+
+__attribute__((target("sse4.1")))
+static int32_t getOutputSse41(const int16_t* own, const int16_t* other){
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i clip = _mm_set1_epi16(CLIP);
+	__m128i sum = zero;
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 8){
+		__m128i ownValues = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(own + i)), zero), clip);
+		__m128i otherValues = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(other + i)), zero), clip);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(ownValues, _mm_load_si128((const __m128i*)(outputWeights[0] + i))));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(otherValues, _mm_load_si128((const __m128i*)(outputWeights[1] + i))));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum) + outputBias;
+}
+
+__attribute__((target("avx2")))
+static void addRowAvx2(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 16){
+		__m256i sum = _mm256_add_epi16(_mm256_load_si256((const __m256i*)(values + i)),
+				_mm256_load_si256((const __m256i*)(row + i)));
+		_mm256_store_si256((__m256i*)(values + i), sum);
+	}
+}
+
+__attribute__((target("avx2")))
+static void subtractRowAvx2(int16_t* values, const int16_t* row){
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 16){
+		__m256i difference = _mm256_sub_epi16(_mm256_load_si256((const __m256i*)(values + i)),
+				_mm256_load_si256((const __m256i*)(row + i)));
+		_mm256_store_si256((__m256i*)(values + i), difference);
+	}
+}
+
+__attribute__((target("avx2")))
+static int32_t getOutputAvx2(const int16_t* own, const int16_t* other){
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i clip = _mm256_set1_epi16(CLIP);
+	__m256i sum = zero;
+	for (int i = 0; i < NUM_OF_HIDDEN; i += 16){
+		__m256i ownValues = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(own + i)), zero), clip);
+		__m256i otherValues = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(other + i)), zero), clip);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(ownValues, _mm256_load_si256((const __m256i*)(outputWeights[0] + i))));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(otherValues, _mm256_load_si256((const __m256i*)(outputWeights[1] + i))));
+	}
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+	return _mm_cvtsi128_si32(half) + outputBias;
+}
+#endif
+
+/* the kernels in use, chosen by chooseKernels */
+static void (*addRow)(int16_t* values, const int16_t* row) = addRowLoop;
+static void (*subtractRow)(int16_t* values, const int16_t* row) = subtractRowLoop;
+static int32_t (*getOutput)(const int16_t* own, const int16_t* other) = getOutputLoop;
+
+/*
+ * Chooses the fastest kernels this processor supports.
+ */
+static void chooseKernels(){
+#ifdef NNUE_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")){
+		addRow = addRowAvx2;
+		subtractRow = subtractRowAvx2;
+		getOutput = getOutputAvx2;
+	}
+	else if (__builtin_cpu_supports("sse4.1")){
+		addRow = addRowSse41;
+		subtractRow = subtractRowSse41;
+		getOutput = getOutputSse41;
+	}
+#endif
+}
+
+/*
+ * Loads the network's weights from (path).
+ *
+ * @return: -1 if the file could not be read or is not a weights file, 0 otherwise
+ */
+int Nnue_load(const char* path){
+	chooseKernels();
+	FILE* file = fopen(path, "rb");
+	if (!file){
+		return -1;
+	}
+	char magic[8];
+	int8_t weights[2*NUM_OF_HIDDEN];
+	int read = fread(magic, 1, 8, file) == 8 && memcmp(magic, Nnue_FILE_MAGIC, 8) == 0
+		&& fread(featureWeights, sizeof(int16_t), NUM_OF_FEATURES*NUM_OF_HIDDEN, file) == NUM_OF_FEATURES*NUM_OF_HIDDEN
+		&& fread(featureBiases, sizeof(int16_t), NUM_OF_HIDDEN, file) == NUM_OF_HIDDEN
+		&& fread(weights, sizeof(int8_t), 2*NUM_OF_HIDDEN, file) == 2*NUM_OF_HIDDEN
+		&& fread(&outputBias, sizeof(int32_t), 1, file) == 1;
+	fclose(file);
+	if (!read){
+		loaded = 0;
+		return -1;
+	}
+	for (int i = 0; i < 2*NUM_OF_HIDDEN; i++){ // widened once so that the output layer works on int16 pairs
+		outputWeights[i / NUM_OF_HIDDEN][i % NUM_OF_HIDDEN] = weights[i];
+	}
+	for (int ply = 0; ply < MAX_PLY; ply++){
+		stack[ply].valid = 0;
+	}
+	loaded = 1;
+	return 0;
+}
+
+int Nnue_isLoaded(){
+	return loaded;
+}
+
+static int getCode(const unsigned char* squares, int square){
+	return (squares[square >> 1] >> ((square & 1) << 2)) & 0xF;
+}
+
+/*
+ * @return: the feature of the piece (code) on (square), seen from (perspective)'s side of the board
+ */
+static int getFeature(int perspective, int code, int square){
+	int color = (Board_COLOR_OF(code) == perspective)? 0: 1;
+	int relativeSquare = (perspective == WHITE)? square: square ^ (NUM_OF_SQUARES - Board_SIZE);
+	return (color*6 + Board_TYPE_OF(code) - 1)*NUM_OF_SQUARES + relativeSquare;
+}
+
+static void addPiece(Accumulator* accumulator, int code, int square){
+	addRow(accumulator->values[WHITE], featureWeights[getFeature(WHITE, code, square)]);
+	addRow(accumulator->values[BLACK], featureWeights[getFeature(BLACK, code, square)]);
+}
+
+static void removePiece(Accumulator* accumulator, int code, int square){
+	subtractRow(accumulator->values[WHITE], featureWeights[getFeature(WHITE, code, square)]);
+	subtractRow(accumulator->values[BLACK], featureWeights[getFeature(BLACK, code, square)]);
+}
+
+/*
+ * Sums the accumulator of (squares) from scratch.
+ */
+static void refresh(Accumulator* accumulator, const unsigned char* squares){
+	memcpy(accumulator->values[WHITE], featureBiases, sizeof(featureBiases));
+	memcpy(accumulator->values[BLACK], featureBiases, sizeof(featureBiases));
+	for (int square = 0; square < NUM_OF_SQUARES; square++){
+		int code = getCode(squares, square);
+		if (code != Board_EMPTY){
+			addPiece(accumulator, code, square);
+		}
+	}
+}
+
+/*
+ * Brings (accumulator), which belongs to (baseSquares), up to date with (squares),
+ * by removing and adding the pieces that differ.
+ */
+static void update(Accumulator* accumulator, const unsigned char* baseSquares, const unsigned char* squares){
+	int numOfUpdates = 0;
+	for (int pair = 0; pair < NUM_OF_SQUARES/2; pair++){
+		if (baseSquares[pair] == squares[pair]){
+			continue;
+		}
+		for (int square = 2*pair; square < 2*pair + 2; square++){
+			int oldCode = getCode(baseSquares, square);
+			int newCode = getCode(squares, square);
+			if (oldCode != newCode){
+				numOfUpdates += (oldCode != Board_EMPTY) + (newCode != Board_EMPTY);
+			}
+		}
+	}
+	if (numOfUpdates > MAX_UPDATES){
+		refresh(accumulator, squares);
+		return;
+	}
+	for (int pair = 0; pair < NUM_OF_SQUARES/2; pair++){
+		if (baseSquares[pair] == squares[pair]){
+			continue;
+		}
+		for (int square = 2*pair; square < 2*pair + 2; square++){
+			int oldCode = getCode(baseSquares, square);
+			int newCode = getCode(squares, square);
+			if (oldCode == newCode){
+				continue;
+			}
+			if (oldCode != Board_EMPTY){
+				removePiece(accumulator, oldCode, square);
+			}
+			if (newCode != Board_EMPTY){
+				addPiece(accumulator, newCode, square);
+			}
+		}
+	}
+}
+
+static int getResult(Accumulator* accumulator, int player){
+	return getOutput(accumulator->values[player], accumulator->values[!player]) / OUTPUT_SCALE;
+}
+
+/*
+ * Evaluates (board) for (player), the player to move, reusing the accumulator of the board
+ * last evaluated one ply earlier in the search, or else at the same ply.
+ *
+ * @params: (ply) - the number of moves between the root of the search and (board)
+ * @return: the score in tenths of a pawn, positive when (player) is ahead
+ */
+int Nnue_evaluate(Board* board, int player, int ply){
+	ply = (ply < MAX_PLY)? ply: MAX_PLY-1;
+	StackEntry* entry = &stack[ply];
+	StackEntry* base = (ply > 0 && stack[ply-1].valid)? &stack[ply-1]: entry;
+	if (!base->valid){
+		refresh(&entry->accumulator, board->squares);
+	}
+	else{
+		if (base != entry){
+			entry->accumulator = base->accumulator;
+		}
+		update(&entry->accumulator, base->squares, board->squares);
+	}
+	memcpy(entry->squares, board->squares, sizeof(entry->squares));
+	entry->valid = 1;
+	return getResult(&entry->accumulator, player);
+}
+
+/*
+ * Evaluates (board) for (player) without reusing any accumulator.
+ */
+int Nnue_evaluateFromScratch(Board* board, int player){
+	Accumulator accumulator;
+	refresh(&accumulator, board->squares);
+	return getResult(&accumulator, player);
+}
+
+/*
+ * Evaluates the board with the network, in the manner of Board_getScore.
+ *
+ * @return: a numeric evaluation of the board, -10001 if an allocation error occurred
+ */
+int Nnue_getScore(Board* board, int scoredForPlayer, int nextPlayer, int ply){
+	//winning or losing scenario
+	int nextPlayerCanMove = Board_possibleMovesExist(board, nextPlayer);
+	if (nextPlayerCanMove == -1){ //allocation error occured in Board_possibleMovesExist
+		return -10001;
+	}
+	if (Board_isInCheck(board, nextPlayer) && !nextPlayerCanMove){
+		return scoredForPlayer == nextPlayer? -Board_MATE: Board_MATE;
+	}
+	//tie
+	if (!nextPlayerCanMove){
+		return 0;
+	}
+	//otherwise, kept well away from the mate scores
+	int score = Nnue_evaluate(board, nextPlayer, ply);
+	score = (score > Board_MATE/2)? Board_MATE/2: (score < -Board_MATE/2)? -Board_MATE/2: score;
+	return (scoredForPlayer == nextPlayer)? score: -score;
+}
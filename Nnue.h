@@ -0,0 +1,32 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Board.h"
+
+/*
+ * An efficiently updatable neural network evaluation.
+ * Each piece on each square, seen from each player's side of the board, is an input feature.
+ * The first layer sums the weights of the present features into an accumulator of int16 values
+ * per player, which is updated from the accumulator of a nearby board by the pieces that differ,
+ * rather than summed again. The output layer weighs the clipped accumulators with int8 weights.
+ *
+ * The weights file holds, in order and little endian: the 8 bytes of Nnue_FILE_MAGIC,
+ * int16 feature weights [768][128], int16 feature biases [128], int8 output weights [2][128]
+ * (the player to move first) and an int32 output bias.
+ * Feature (color*6 + type-1)*64 + square is the piece of the given type and color (0 for the player's own)
+ * on the square, mirrored vertically for black. The output is divided by 16, in tenths of a pawn.
+ */
+#define Nnue_FILE "nnue.bin"
+#define Nnue_FILE_MAGIC "NNUE0001"
+
+int Nnue_load(const char* path);
+
+int Nnue_isLoaded();
+
+int Nnue_evaluate(Board* board, int player, int ply);
+
+int Nnue_evaluateFromScratch(Board* board, int player);
+
+int Nnue_getScore(Board* board, int scoredForPlayer, int nextPlayer, int ply);
+
+#endif
@@ -1,6 +1,5 @@
 #include "PieceCounter.h"
 #include "Board.h"
-#include <ctype.h>
 
 
 /* 
@@ -18,6 +17,12 @@ static int isOnWhite(int x, int y){
 	return (x+y)%2;
 }
 
+/*
+ * The index of the counter of each piece type. 
+ * Bishops on black tiles use the counter following this one.
+ */
+static const int counterIndex[7] = {-1, 0, 1, 3, 2, 5, 6};
+
 /*
  * Auxilary function for assigning a number for each type of piece, 
  * so the appropriate counter could be updated when necessary.
@@ -25,31 +30,12 @@ static int isOnWhite(int x, int y){
  *          (x, y) - the location of the piece
  * @return: the index of the appropriate counter for this piece 
  */
-
 static int pieceToNum(char piece, int x, int y){
-	switch(piece){
-		case Board_BLACK_PAWN:
-		case Board_WHITE_PAWN:   return 0;
-		case Board_BLACK_KNIGHT: 
-		case Board_WHITE_KNIGHT: return 1;
-		case Board_BLACK_ROOK:
-		case Board_WHITE_ROOK:   return 2;
-		case Board_BLACK_BISHOP:
-		case Board_WHITE_BISHOP: return isOnWhite(x,y)? 3: 4;
-		case Board_BLACK_QUEEN:
-		case Board_WHITE_QUEEN:  return 5;
-		case Board_BLACK_KING:
-		case Board_WHITE_KING:   return 6;
+	int type = Board_TYPE_OF(piece);
+	if (type == Board_BISHOP && !isOnWhite(x, y)){
+		return counterIndex[type] + 1;
 	}
-	return -1; //should never happen
-}
-
-/*
- * @return: BLACK(0) if (piece) belongs to the black player, 
- *			WHITE(1) if it belongs to the white player
- */
-static int getColor(char piece){
-	return toupper(piece) == piece? BLACK: WHITE;
+	return counterIndex[type];
 }
 
 /*
@@ -61,7 +47,7 @@ static int getColor(char piece){
  */
 int PieceCounter_isAtMax(int counter[2][7], char piece, int x, int y){
 	int num = pieceToNum(piece, x, y);
-	int color = getColor(piece);
+	int color = Board_COLOR_OF(piece);
 	return counter[color][num] == max[num];
 }
 
@@ -77,7 +63,7 @@ void PieceCounter_update(int counter[2][7], char piece, int amountToAdd, int x,
 		return;
 	}
 	int num = pieceToNum(piece, x, y);
-	int color = getColor(piece);
+	int color = Board_COLOR_OF(piece);
 	counter[color][num] += amountToAdd;
 }
 
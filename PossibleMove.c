@@ -48,15 +48,11 @@ int PossibleMove_equals(PossibleMove* this, PossibleMove* other){
 void PossibleMove_print(PossibleMove* move){
 	if (move->toX != 0){
 		printf("<%c,%d> to <%c,%d>", move->fromX+96, move->fromY, move->toX+96, move->toY);
-		switch(move->promotion){
-			case 'b':
-			case 'B': printf(" bishop\n"); break;
-			case 'r': 
-			case 'R': printf(" rook\n"); break;
-			case 'n': 
-			case 'N': printf(" knight\n"); break;
-			case 'q':
-			case 'Q': printf(" queen\n"); break;
+		switch(Board_TYPE_OF(move->promotion)){
+			case Board_BISHOP: printf(" bishop\n"); break;
+			case Board_ROOK:   printf(" rook\n"); break;
+			case Board_KNIGHT: printf(" knight\n"); break;
+			case Board_QUEEN:  printf(" queen\n"); break;
 			default: printf("\n");
 		}
 	}
@@ -1,13 +1,26 @@
 #ifndef POSSIBLEMOVE_H
 #define POSSIBLEMOVE_H
 
+#include <stdint.h>
+
+/*
+ * A position packed into a single 64-byte, 64-byte aligned block, so that copying
+ * a board is one aligned block move. Squares are indexed a1 = 0 ... h8 = 63 and
+ * hold two 4-bit pieces per byte. (occupied) holds the squares of each player's pieces,
+ * one bit per square, so that the pieces can be visited without scanning empty squares. 
+ * (key) is a hash of the position, kept up to date on every change, 
+ * and (pawnKey) a hash of the pawns alone, which only changes when pawns move or are captured.
+ * (castlingRights) holds one bit per player and side, see Board_CASTLING_RIGHT.
+ */
 typedef struct Board{
-	char matrix[8][8];
-	int kingX[2];
-	int kingY[2];
-	int hasKingEverMoved[2];
-	int hasRookEverMoved[2][2];
-} Board;
+	unsigned char squares[32];
+	uint64_t occupied[2];
+	uint64_t key;
+	uint32_t pawnKey;
+	unsigned char kingSquare[2];
+	unsigned char castlingRights;
+	unsigned char sideToMove;
+} __attribute__((aligned(64))) Board;
 
 
 typedef struct PossibleMove{